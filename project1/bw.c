@@ -1,27 +1,68 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "string.h"
 #include "simp.h"
+#include "pool/pool.h"
 
 /**
  * Program that converts an image to black and white
- * Usage: ./bw infile outfile
+ * Usage: ./bw [-j jobs] infile outfile
+ *        ./bw [-j jobs] -i file
  * @author Alex Cole
  */
 int main(int argc, char*argv[])
 {
     simp_t image;
+    simp_stream_t in, out;
+    int jobs, rows, error;
 
+    if(read_jobs_option(&argc, argv, &jobs) != 0) return 1;
     if(argc != 3)
     {
-        fprintf(stderr, "Usage: ./bw infile outfile\n");
+        fprintf(stderr, "Usage: ./bw [-j jobs] infile outfile\n       ./bw [-j jobs] -i file\n");
         return 1;
     }
 
-    /*reads simp file info and then converts the image to black and white*/
-    if(read_simp_file(argv[1], &image) != 0) return 1;
-    simp2bw(&image);
-    write_simp_file(argv[2], &image);
+    /*maps the file and converts the image to black and white where the pixels are stored in the file*/
+    if(strcmp(argv[1], "-i") == 0)
+    {
+        if(map_simp_file(argv[2], &image) != 0) return 1;
+        start_pool(jobs);
+        simp2bw(&image);
+        stop_pool();
+        free_pixels(&image);
+        return 0;
+    }
+
+    /*reads the simp file a band of rows at a time and writes each band converted to black and white*/
+    if(open_simp_reader(argv[1], &in) != 0) return 1;
+    if(allocate_band(in.width, in.height, &image) != 0)
+    {
+        close_simp_reader(&in);
+        return 1;
+    }
+    rows = image.height;
+    if(open_simp_writer(argv[2], &out, in.width, in.height) != 0)
+    {
+        close_simp_reader(&in);
+        free_pixels(&image);
+        return 1;
+    }
+
+    error = 0;
+    start_pool(jobs);
+    while(!error && in.row < in.height)
+    {
+        error = read_simp_rows(&in, &image, rows);
+        if(!error)
+        {
+            simp2bw(&image);
+            error = write_simp_rows(&out, &image);
+        }
+    }
+    stop_pool();
 
+    close_simp_reader(&in);
     free_pixels(&image);
-    return 0;
+    return close_simp_writer(&out, error);
 }
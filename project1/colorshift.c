@@ -1,27 +1,75 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "string.h"
 #include "simp.h"
+#include "pool/pool.h"
 
 /**
  * Program that shifts the colors of an image based on given shift pattern
- * Usage: ./colorshift infile outfile pattern
+ * Usage: ./colorshift [-j jobs] infile outfile pattern
+ *        ./colorshift [-j jobs] -i file pattern
  * @author Alex Cole
  */
 int main(int argc, char*argv[])
 {
     simp_t image;
+    simp_stream_t in, out;
+    unsigned char order[4];
+    int jobs, rows, error;
 
+    if(read_jobs_option(&argc, argv, &jobs) != 0) return 1;
     if(argc != 4)
     {
-        fprintf(stderr, "Usage: ./colorshift infile outfile pattern\n");
+        fprintf(stderr, "Usage: ./colorshift [-j jobs] infile outfile pattern\n       ./colorshift [-j jobs] -i file pattern\n");
         return 1;
     }
 
-    /*reads simp file info and then shifts the colors with the given pattern*/
-    if(read_simp_file(argv[1], &image) != 0) return 1;
-    if(simp_colorshift(argv[3], &image) != 0) return 1;
-    write_simp_file(argv[2], &image);
+    /*maps the file and shifts the colors where the pixels are stored in the file*/
+    if(strcmp(argv[1], "-i") == 0)
+    {
+        if(map_simp_file(argv[2], &image) != 0) return 1;
+        start_pool(jobs);
+        error = simp_colorshift(argv[3], &image);
+        stop_pool();
+        if(error != 0) return 1;
+        free_pixels(&image);
+        return 0;
+    }
+
+    /*reads the simp file a band of rows at a time and writes each band with the colors shifted*/
+    if(open_simp_reader(argv[1], &in) != 0) return 1;
+    if(get_colorshift_order(argv[3], order) != 0)
+    {
+        close_simp_reader(&in);
+        return 1;
+    }
+    if(allocate_band(in.width, in.height, &image) != 0)
+    {
+        close_simp_reader(&in);
+        return 1;
+    }
+    rows = image.height;
+    if(open_simp_writer(argv[2], &out, in.width, in.height) != 0)
+    {
+        close_simp_reader(&in);
+        free_pixels(&image);
+        return 1;
+    }
+
+    error = 0;
+    start_pool(jobs);
+    while(!error && in.row < in.height)
+    {
+        error = read_simp_rows(&in, &image, rows);
+        if(!error)
+        {
+            shift_colors(&image, order);
+            error = write_simp_rows(&out, &image);
+        }
+    }
+    stop_pool();
 
+    close_simp_reader(&in);
     free_pixels(&image);
-    return 0;
+    return close_simp_writer(&out, error);
 }
@@ -1,35 +1,69 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "simp.h"
+#include "pool/pool.h"
 
 /**
  * Program that crops an image
- * Usage: infile outfile x y width height
+ * Usage: [-j jobs] infile outfile x y width height
  * @author Alex Cole
  */
 int main(int argc, char*argv[])
 {
     simp_t image;
     simp_t cropimage;
+    simp_stream_t in, out;
+    int x, y, width, height, jobs, rows, error;
 
+    if(read_jobs_option(&argc, argv, &jobs) != 0) return 1;
     if(argc != 7)
     {
-        fprintf(stderr, "Usage: ./crop infile outfile x y width height\n");
+        fprintf(stderr, "Usage: ./crop [-j jobs] infile outfile x y width height\n");
         return 1;
     }
+    x = atoi(argv[3]);
+    y = atoi(argv[4]);
+    width = atoi(argv[5]);
+    height = atoi(argv[6]);
 
     /*reads simp file info*/
-    if(read_simp_file(argv[1], &image) != 0) return 1;
+    if(open_simp_reader(argv[1], &in) != 0) return 1;
 
     /*checks to see if x, y, height and width are in valid range*/
-    if(valid_ranges(atoi(argv[3]), atoi(argv[4]), atoi(argv[5]), atoi(argv[6]), &image) != 0) return 1;
+    if(check_ranges(x, y, width, height, in.width, in.height) != 0)
+    {
+        close_simp_reader(&in);
+        return 1;
+    }
 
-    /*crop and store cropped image data*/
-    crop_simp(atoi(argv[5]), atoi(argv[6]), atoi(argv[3]), atoi(argv[4]), &image, &cropimage);
-    free_pixels(&image);
+    if(allocate_band(in.width, height, &image) != 0)
+    {
+        close_simp_reader(&in);
+        return 1;
+    }
+    rows = image.height;
+    if(open_simp_writer(argv[2], &out, width, height) != 0)
+    {
+        close_simp_reader(&in);
+        free_pixels(&image);
+        return 1;
+    }
 
-    write_simp_file(argv[2], &cropimage);
+    /*reads the rows being kept a band at a time and writes the cropped part of each band*/
+    error = skip_simp_rows(&in, y);
+    start_pool(jobs);
+    while(!error && out.row < height)
+    {
+        error = read_simp_rows(&in, &image, height - out.row < rows ? height - out.row : rows);
+        if(!error)
+        {
+            crop_simp(width, image.height, x, 0, &image, &cropimage);
+            error = write_simp_rows(&out, &cropimage);
+        }
+    }
+    stop_pool();
 
-    free_pixels(&cropimage);
-    return 0;
+    close_simp_reader(&in);
+    free_pixels(&image);
+    return close_simp_writer(&out, error);
 }
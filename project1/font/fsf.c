@@ -57,6 +57,7 @@ int fill_characters(FILE *ifp, fsf_t *font)
         {
             char *num;
             font->characters[i].ch = variable[9] == '\0' ? ':' : variable[9];
+            font->characters[i].valid = 0;
 
             num = strtok(value, " ");
             if(num == NULL)
@@ -147,46 +148,84 @@ int read_fsf_file(char *name, fsf_t *font)
         return 1;
     }
 
+    build_atlas(font);
+
     fclose(in);
     return 0;
 }
 
 /**
- * @brief finds a character based on the given character in an array of
- * characters
- * @param characters an array of character structs
- * @param length how many items are in the array
- * @param ch the character to be found
- * @return a character_t struct with the data for that character
+ * @brief fills the atlas of a font, where atlas[c] is the first character in the font file for
+ * the character c, so characters can be found without searching
+ * @param font the font with its characters filled
  */
-character_t* get_character(character_t *characters, int length, char ch)
+void build_atlas(fsf_t *font)
 {
     int i;
-    for(i = 0; i < length; i++)
+
+    for(i = 0; i < 256; i++)
+    {
+        font->atlas[i] = NULL;
+    }
+
+    /*goes backwards so the first character in the file is the one kept*/
+    for(i = font->num_characters - 1; i >= 0; i--)
     {
-        if(characters[i].ch == ch) return &characters[i];
+        font->atlas[(unsigned char) font->characters[i].ch] = &font->characters[i];
     }
-    return NULL;
+}
+
+/**
+ * @brief checks which characters are inside the font image, the same way valid_ranges does for
+ * a simp image, so they only need to be checked once
+ * @param font the font
+ * @param width the width of the font image
+ * @param height the height of the font image
+ */
+void check_characters(fsf_t *font, int width, int height)
+{
+    int i;
+
+    for(i = 0; i < font->num_characters; i++)
+    {
+        int *position;
+
+        /*-1 value for width and height means it does not need to be checked*/
+        position = font->characters[i].position;
+        font->characters[i].valid = position[0] >= 0 && position[0] <= width - 1
+            && position[1] >= 0 && position[1] <= height - 1
+            && (position[2] == -1 || (position[2] + position[0] >= 1 && position[2] + position[0] <= width))
+            && (position[3] == -1 || (position[3] + position[1] >= 1 && position[3] + position[1] <= height));
+    }
+}
+
+/**
+ * @brief finds a character in the font with the atlas. if the font file has the character more
+ * than once the first one is found
+ * @param font the font
+ * @param ch the character to be found
+ * @return a character_t struct with the data for that character or NULL if it is not in the font
+ */
+character_t* get_character(fsf_t *font, char ch)
+{
+    return font->atlas[(unsigned char) ch];
 }
 
 /**
  * @brief calculates the width of a phrase
- * @param characters an array of character structs
- * @param how many items are in the array
+ * @param font the font
  * @param phrase the text phrase
  * @return returns the width of the given phrase. default value is 0
  */
-int get_phrase_width(character_t *characters, int length, char *phrase)
+int get_phrase_width(fsf_t *font, char *phrase)
 {
     character_t *character;
-    size_t phrase_length;
-    int width, i;
+    int width;
 
     width = 0;
-    phrase_length = strlen(phrase);
-    for(i = 0; i < phrase_length; i++)
+    for(; *phrase != '\0'; phrase++)
     {
-        character = get_character(characters, length, phrase[i]);
+        character = get_character(font, *phrase);
         if(character != NULL) width += character->position[2];
     }
     return width;
@@ -219,6 +258,7 @@ void initialize_fsf(fsf_t *font)
     font->image = NULL;
     font->num_characters = 0;
     font->characters = NULL;
+    build_atlas(font);
 }
 
 /**
@@ -9,21 +9,25 @@
 
 /*struct to store character data. ch is the character
 position[0] is the x pos, position[1] is the y pos,
-position[2] is the width, and position[3] us the height*/
+position[2] is the width, and position[3] us the height.
+valid is non-zero if check_characters found the character inside the font image*/
 struct character
 {
     char ch;
     int position[4];
+    int valid;
 };
 typedef struct character character_t;
 
-/*struct to store fsf file info*/
+/*struct to store fsf file info. atlas has a pointer into characters for each
+of the 256 char values, or NULL if the font does not have that character*/
 struct fsf
 {
     char *name;
     char *image;
     int num_characters;
     character_t *characters;
+    character_t *atlas[256];
 };
 typedef struct fsf fsf_t;
 
@@ -52,23 +56,37 @@ int fill_characters(FILE *ifp, fsf_t *font);
 int read_fsf_file(char *name, fsf_t *font);
 
 /**
- * @brief finds a character based on the given character in an array of
- * characters
- * @param characters an array of character structs
- * @param length how many items are in the array
+ * @brief fills the atlas of a font, where atlas[c] is the first character in the font file for
+ * the character c, so characters can be found without searching
+ * @param font the font with its characters filled
+ */
+void build_atlas(fsf_t *font);
+
+/**
+ * @brief checks which characters are inside the font image, the same way valid_ranges does for
+ * a simp image, so they only need to be checked once
+ * @param font the font
+ * @param width the width of the font image
+ * @param height the height of the font image
+ */
+void check_characters(fsf_t *font, int width, int height);
+
+/**
+ * @brief finds a character in the font with the atlas. if the font file has the character more
+ * than once the first one is found
+ * @param font the font
  * @param ch the character to be found
- * @return a character_t struct with the data for that character
+ * @return a character_t struct with the data for that character or NULL if it is not in the font
  */
-character_t* get_character(character_t *characters, int length, char ch);
+character_t* get_character(fsf_t *font, char ch);
 
 /**
  * @brief calculates the width of a phrase
- * @param characters an array of character structs
- * @param how many items are in the array
+ * @param font the font
  * @param phrase the text phrase
  * @return returns the width of the given phrase. default value is 0
  */
-int get_phrase_width(character_t *characters, int length, char *phrase);
+int get_phrase_width(fsf_t *font, char *phrase);
 
 /**
  * @brief gets the height of the characters
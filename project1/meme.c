@@ -65,6 +65,7 @@ int main(int argc, char *argv[])
         free_pixels(&image);
         return 1;
     }
+    check_characters(&font, font_image.width, font_image.height);
 
     /*goes through each text id and tries to overlay the text if it also exists in the meme file*/
     for(i = 0; i < action.num_ids; i++)
@@ -81,18 +82,19 @@ int main(int argc, char *argv[])
             character_t *character;
 
             /*align text in the center*/
-            phrase_width = get_phrase_width(font.characters, font.num_characters, phrase);
+            phrase_width = get_phrase_width(&font, phrase);
             x = position->startpoint.x - (phrase_width / 2);
             y = position->startpoint.y - get_height(font.characters);
             length = strlen(phrase);
             for(j = 0; j < length; j++)
             {
-                character = get_character(font.characters, font.num_characters, phrase[j]);
+                character = get_character(&font, phrase[j]);
                 if(character != NULL)
                 {
-                    /*checks to see if x, y, height and width are in valid range*/
-                    if(valid_ranges(character->position[0], character->position[1], character->position[2], character->position[3], &font_image) != 0)
+                    /*x, y, height and width were checked when the font image was read. valid_ranges reports why they are not in range*/
+                    if(!character->valid)
                     {
+                        valid_ranges(character->position[0], character->position[1], character->position[2], character->position[3], &font_image);
                         fprintf(stderr, "Character is invalid: %c\n", character->ch);
                         deallocate_fsf(&font);
                         deallocate_act(&action);
@@ -101,10 +103,10 @@ int main(int argc, char *argv[])
                         return 1;
                     }
 
+                    /*the character is overlaid straight from the font image*/
                     crop_simp(character->position[2], character->position[3], character->position[0], character->position[1], &font_image, &crop_image);
                     simp_overlay(&image, &crop_image, x, y);
                     x += crop_image.width;
-                    free_pixels(&crop_image);
                 }
                 else /*character is not in font file, but does not cause program to stop, just skips character*/
                 {
@@ -122,7 +124,12 @@ int main(int argc, char *argv[])
     deallocate_mem(&memes);
     free_pixels(&font_image);
 
-    write_simp_file(action.outfile, &image);
+    if(write_simp_file(action.outfile, &image) != 0)
+    {
+        deallocate_act(&action);
+        free_pixels(&image);
+        return 1;
+    }
 
     deallocate_act(&action);
     free_pixels(&image);
@@ -1,39 +1,93 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "simp.h"
+#include "pool/pool.h"
 
 /**
  * Program that overlays one image on top of another image
- * Usage: ./overlay bottomimage topimage outfile x y
+ * Usage: ./overlay [-j jobs] bottomimage topimage outfile x y
  * @author Alex Cole
  */
 int main(int argc, char*argv[])
 {
     simp_t imagebottom;
     simp_t imagetop;
+    simp_stream_t bottom, top, out;
+    int x, y, jobs, rows, toprowsmax, left, right, error;
 
+    if(read_jobs_option(&argc, argv, &jobs) != 0) return 1;
     if(argc != 6)
     {
-        fprintf(stderr, "Usage: ./overlay bottomfile topfile outfile x y\n");
+        fprintf(stderr, "Usage: ./overlay [-j jobs] bottomfile topfile outfile x y\n");
         return 1;
     }
+    x = atoi(argv[4]);
+    y = atoi(argv[5]);
 
     /*read bottom image info*/
-    if(read_simp_file(argv[1], &imagebottom) != 0) return 1;
+    if(open_simp_reader(argv[1], &bottom) != 0) return 1;
 
     /*reads top image info*/
-    if(read_simp_file(argv[2], &imagetop) != 0)
+    if(open_simp_reader(argv[2], &top) != 0)
     {
+        close_simp_reader(&bottom);
+        return 1;
+    }
+
+    if(allocate_band(bottom.width, bottom.height, &imagebottom) != 0)
+    {
+        close_simp_reader(&bottom);
+        close_simp_reader(&top);
+        return 1;
+    }
+    rows = imagebottom.height;
+
+    /*only the columns of the top image that are over the bottom image are read, into a band of their own*/
+    left = x < 0 ? -x : 0;
+    right = top.width < bottom.width - x ? top.width : bottom.width - x;
+    if(allocate_band(right > left ? right - left : 1, top.height, &imagetop) != 0)
+    {
+        close_simp_reader(&bottom);
+        close_simp_reader(&top);
         free_pixels(&imagebottom);
         return 1;
     }
+    toprowsmax = imagetop.height;
+    if(open_simp_writer(argv[3], &out, bottom.width, bottom.height) != 0)
+    {
+        close_simp_reader(&bottom);
+        close_simp_reader(&top);
+        free_pixels(&imagebottom);
+        free_pixels(&imagetop);
+        return 1;
+    }
 
-    /*overlays the top image on the bottom image*/
-    simp_overlay(&imagebottom, &imagetop, atoi(argv[4]), atoi(argv[5]));
-    free_pixels(&imagetop);
+    /*top image rows above the bottom image are never overlaid*/
+    error = y < 0 ? skip_simp_rows(&top, -y) : 0;
+    start_pool(jobs);
+    while(!error && bottom.row < bottom.height)
+    {
+        int start, toprows;
 
-    write_simp_file(argv[3], &imagebottom);
+        /*overlays the top image rows that are over the band on the band, as many as the top band holds at a time*/
+        start = bottom.row;
+        error = read_simp_rows(&bottom, &imagebottom, rows);
+        toprows = (start + imagebottom.height - y < top.height ? start + imagebottom.height - y : top.height) - top.row;
+        while(!error && toprows > 0 && right > left)
+        {
+            int toprow;
+            toprow = top.row;
+            error = read_simp_columns(&top, &imagetop, toprows < toprowsmax ? toprows : toprowsmax, left);
+            if(!error) simp_overlay(&imagebottom, &imagetop, x + left, toprow + y - start);
+            toprows -= imagetop.height;
+        }
+        if(!error) error = write_simp_rows(&out, &imagebottom);
+    }
+    stop_pool();
 
+    close_simp_reader(&bottom);
+    close_simp_reader(&top);
     free_pixels(&imagebottom);
-    return 0;
+    free_pixels(&imagetop);
+    return close_simp_writer(&out, error);
 }
@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "string.h"
+#include "simp.h"
+#include "pool/pool.h"
+
+/**
+ * Program that runs a chain of crop, bw, colorshift and overlay operations on an image in one pass,
+ * reading the image once and writing the result once
+ * Usage: ./simp [-j jobs] infile outfile operation...
+ * @author Alex Cole
+ */
+
+/*kinds of operations in a pipeline*/
+#define STAGE_BW 0
+#define STAGE_COLORSHIFT 1
+#define STAGE_OVERLAY 2
+
+/*struct for one operation of a pipeline. crops are not stages, they only move the part of the image
+that is kept. x and y are where an overlay's top image starts in the resulting image, and left and
+right are the columns of the top image over the resulting image, which are the only ones read*/
+struct stage
+{
+    int type;
+    unsigned char order[4];
+    simp_stream_t top;
+    simp_t topband;
+    int x;
+    int y;
+    int left;
+    int right;
+    int toprows;
+};
+typedef struct stage stage_t;
+
+/**
+ * @brief prints how the program is used
+ */
+static void print_usage(void)
+{
+    fprintf(stderr, "Usage: ./simp [-j jobs] infile outfile operation...\n");
+    fprintf(stderr, "Operations: crop x y width height\n");
+    fprintf(stderr, "            bw\n");
+    fprintf(stderr, "            colorshift pattern\n");
+    fprintf(stderr, "            overlay topfile x y\n");
+}
+
+/**
+ * @brief closes the top images of the overlay stages and frees their bands
+ * @param stages the stages
+ * @param count the number of stages
+ */
+static void close_stages(stage_t *stages, int count)
+{
+    int i;
+
+    for(i = 0; i < count; i++)
+    {
+        if(stages[i].type == STAGE_OVERLAY)
+        {
+            close_simp_reader(&stages[i].top);
+            free_pixels(&stages[i].topband);
+        }
+    }
+    free(stages);
+}
+
+/**
+ * @brief reads the operations of a pipeline. crops are checked against the size of the image at that
+ * point in the pipeline and combined into one crop of the original image
+ * @param argc the number of arguments
+ * @param argv the arguments, where the operations start at argv[3]
+ * @param in the image being read
+ * @param stages set to the stages, which must be closed with close_stages
+ * @param count set to the number of stages
+ * @param crop set to the x, y, width and height of the part of the original image that is kept
+ * @return 0 if the operations are valid otherwise 1
+ */
+static int read_stages(int argc, char *argv[], simp_stream_t *in, stage_t **stages, int *count, int crop[4])
+{
+    int i;
+
+    *count = 0;
+    *stages = malloc(argc * sizeof(stage_t));
+    if(*stages == NULL)
+    {
+        fprintf(stderr, "Could not allocate pipeline\n");
+        return 1;
+    }
+    crop[0] = 0;
+    crop[1] = 0;
+    crop[2] = in->width;
+    crop[3] = in->height;
+
+    i = 3;
+    while(i < argc)
+    {
+        stage_t *stage;
+
+        stage = &(*stages)[*count];
+        if(strcmp(argv[i], "crop") == 0 && i + 4 < argc)
+        {
+            int x, y;
+
+            x = atoi(argv[i + 1]);
+            y = atoi(argv[i + 2]);
+            if(check_ranges(x, y, atoi(argv[i + 3]), atoi(argv[i + 4]), crop[2], crop[3]) != 0) break;
+            crop[0] += x;
+            crop[1] += y;
+            crop[2] = atoi(argv[i + 3]);
+            crop[3] = atoi(argv[i + 4]);
+            i += 5;
+        }
+        else if(strcmp(argv[i], "bw") == 0)
+        {
+            stage->type = STAGE_BW;
+            (*count)++;
+            i += 1;
+        }
+        else if(strcmp(argv[i], "colorshift") == 0 && i + 1 < argc)
+        {
+            if(get_colorshift_order(argv[i + 1], stage->order) != 0) break;
+            stage->type = STAGE_COLORSHIFT;
+            (*count)++;
+            i += 2;
+        }
+        else if(strcmp(argv[i], "overlay") == 0 && i + 3 < argc)
+        {
+            if(open_simp_reader(argv[i + 1], &stage->top) != 0) break;
+            stage->type = STAGE_OVERLAY;
+            stage->topband.block = NULL;
+            stage->topband.mapped = 0;
+
+            /*the position is in the image cropped so far, and is kept as a position in the original image
+            until every crop is known*/
+            stage->x = atoi(argv[i + 2]) + crop[0];
+            stage->y = atoi(argv[i + 3]) + crop[1];
+            (*count)++;
+            i += 4;
+        }
+        else
+        {
+            fprintf(stderr, "Invalid operation: %s\n", argv[i]);
+            print_usage();
+            break;
+        }
+    }
+    if(i < argc)
+    {
+        close_stages(*stages, *count);
+        return 1;
+    }
+
+    for(i = 0; i < *count; i++)
+    {
+        (*stages)[i].x -= crop[0];
+        (*stages)[i].y -= crop[1];
+    }
+    return 0;
+}
+
+/**
+ * @brief allocates the bands the overlay stages read the columns of their top images that are over
+ * the resulting image into and skips the rows of the top images that are above the resulting image
+ * @param stages the stages
+ * @param count the number of stages
+ * @param width the width of the resulting image
+ * @return 0 if the bands were allocated otherwise 1
+ */
+static int start_stages(stage_t *stages, int count, int width)
+{
+    int i;
+
+    for(i = 0; i < count; i++)
+    {
+        stage_t *stage;
+
+        stage = &stages[i];
+        if(stage->type == STAGE_OVERLAY)
+        {
+            stage->left = stage->x < 0 ? -stage->x : 0;
+            stage->right = stage->top.width < width - stage->x ? stage->top.width : width - stage->x;
+            if(allocate_band(stage->right > stage->left ? stage->right - stage->left : 1, stage->top.height, &stage->topband) != 0) return 1;
+            stage->toprows = stage->topband.height;
+            if(stage->y < 0 && skip_simp_rows(&stage->top, -stage->y) != 0) return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief runs every stage on a band of the resulting image
+ * @param stages the stages
+ * @param count the number of stages
+ * @param band the band
+ * @param start the row of the resulting image the band starts at
+ * @return 0 if the stages were run otherwise 1 if there was a problem reading a top image
+ */
+static int run_stages(stage_t *stages, int count, simp_t *band, int start)
+{
+    int i;
+
+    for(i = 0; i < count; i++)
+    {
+        stage_t *stage;
+
+        stage = &stages[i];
+        if(stage->type == STAGE_BW)
+        {
+            simp2bw(band);
+        }
+        else if(stage->type == STAGE_COLORSHIFT)
+        {
+            shift_colors(band, stage->order);
+        }
+        else
+        {
+            int toprow, toprows;
+
+            /*overlays the top image rows that are over the band on the band, as many as the top band holds at a time*/
+            toprows = (start + band->height - stage->y < stage->top.height ? start + band->height - stage->y : stage->top.height) - stage->top.row;
+            while(toprows > 0 && stage->right > stage->left)
+            {
+                toprow = stage->top.row;
+                if(read_simp_columns(&stage->top, &stage->topband, toprows < stage->toprows ? toprows : stage->toprows, stage->left) != 0) return 1;
+                simp_overlay(band, &stage->topband, stage->x + stage->left, toprow + stage->y - start);
+                toprows -= stage->topband.height;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char*argv[])
+{
+    simp_t image, band;
+    simp_stream_t in, out;
+    stage_t *stages;
+    int crop[4];
+    int count, jobs, rows, error;
+
+    if(read_jobs_option(&argc, argv, &jobs) != 0) return 1;
+    if(argc < 3)
+    {
+        print_usage();
+        return 1;
+    }
+
+    if(open_simp_reader(argv[1], &in) != 0) return 1;
+    if(read_stages(argc, argv, &in, &stages, &count, crop) != 0)
+    {
+        close_simp_reader(&in);
+        return 1;
+    }
+
+    /*only the rows being kept are read, a band at a time*/
+    if(allocate_band(in.width, crop[3], &image) != 0)
+    {
+        close_simp_reader(&in);
+        close_stages(stages, count);
+        return 1;
+    }
+    rows = image.height;
+    if(start_stages(stages, count, crop[2]) != 0 || skip_simp_rows(&in, crop[1]) != 0)
+    {
+        close_simp_reader(&in);
+        close_stages(stages, count);
+        free_pixels(&image);
+        return 1;
+    }
+    if(open_simp_writer(argv[2], &out, crop[2], crop[3]) != 0)
+    {
+        close_simp_reader(&in);
+        close_stages(stages, count);
+        free_pixels(&image);
+        return 1;
+    }
+
+    error = 0;
+    start_pool(jobs);
+    while(!error && out.row < crop[3])
+    {
+        int start;
+
+        start = out.row;
+        error = read_simp_rows(&in, &image, crop[3] - start < rows ? crop[3] - start : rows);
+        if(!error)
+        {
+            /*the columns being kept are used where they are in the band, without being copied*/
+            crop_simp(crop[2], image.height, crop[0], 0, &image, &band);
+            error = run_stages(stages, count, &band, start);
+        }
+        if(!error) error = write_simp_rows(&out, &band);
+    }
+    stop_pool();
+
+    close_simp_reader(&in);
+    close_stages(stages, count);
+    free_pixels(&image);
+    return close_simp_writer(&out, error);
+}
@@ -0,0 +1,195 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include "string.h"
+#include <pthread.h>
+#include "pool.h"
+
+/**
+ * Implementation of pool prototypes in pool.h
+ * @author Alex Cole
+ */
+
+/*the threads of the pool, not counting the thread that calls run_rows*/
+static pthread_t workers[POOL_MAX_THREADS - 1];
+static int thread_count = 0;
+
+/*the task being run. job is counted up each time run_rows gives the threads a task and remaining is
+the number of threads that have not finished their band of it*/
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t job_done = PTHREAD_COND_INITIALIZER;
+static rows_task_t job_task;
+static void *job_arg;
+static int job_rows;
+static unsigned long job = 0;
+static int remaining = 0;
+static int stopping = 0;
+
+/**
+ * @brief gets the first row of a band. the rows are split as evenly as they can be, with the first
+ * rows % bands bands getting one more row
+ * @param rows the number of rows
+ * @param band the band, where band 0 is done by the thread that calls run_rows
+ * @return the first row of the band
+ */
+static int band_start(int rows, int band)
+{
+    int bands, extra;
+
+    bands = thread_count + 1;
+    extra = rows % bands;
+    return rows / bands * band + (band < extra ? band : extra);
+}
+
+/**
+ * @brief waits for tasks and runs them on the band of rows for a thread until the pool is stopped
+ * @param arg the band of the thread
+ * @return NULL
+ */
+static void* work(void *arg)
+{
+    int band;
+    unsigned long done;
+
+    band = (int) (size_t) arg;
+    done = 0;
+    while(1)
+    {
+        rows_task_t task;
+        void *taskarg;
+        int start, end;
+
+        pthread_mutex_lock(&lock);
+        while(!stopping && job == done)
+        {
+            pthread_cond_wait(&job_ready, &lock);
+        }
+        if(stopping)
+        {
+            pthread_mutex_unlock(&lock);
+            return NULL;
+        }
+        done = job;
+        task = job_task;
+        taskarg = job_arg;
+        start = band_start(job_rows, band);
+        end = band_start(job_rows, band + 1);
+        pthread_mutex_unlock(&lock);
+
+        if(start < end) task(taskarg, start, end);
+
+        pthread_mutex_lock(&lock);
+        remaining--;
+        if(remaining == 0) pthread_cond_signal(&job_done);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+/**
+ * @brief starts a pool of threads that run_rows splits rows between. the calling thread is one of the
+ * threads, so threads - 1 threads are created. if a thread can not be created the pool uses the threads
+ * that were created
+ * @param threads the number of threads to split rows between
+ */
+void start_pool(int threads)
+{
+    if(threads > POOL_MAX_THREADS) threads = POOL_MAX_THREADS;
+    thread_count = 0;
+    while(thread_count < threads - 1)
+    {
+        /*band 0 is done by the thread that calls run_rows, so the thread created here does the next band*/
+        if(pthread_create(&workers[thread_count], NULL, work, (void*) (size_t) (thread_count + 1)) != 0) break;
+        thread_count++;
+    }
+}
+
+/**
+ * @brief runs a task on rows 0 to rows - 1, giving each thread of the pool a band of rows, and waits
+ * for every band to be done. without a pool the task is run on all of the rows by the calling thread
+ * @param task the function that does the work for a band of rows
+ * @param arg the argument given to task
+ * @param rows the number of rows
+ */
+void run_rows(rows_task_t task, void *arg, int rows)
+{
+    if(thread_count == 0 || rows < 2)
+    {
+        task(arg, 0, rows);
+        return;
+    }
+
+    pthread_mutex_lock(&lock);
+    job_task = task;
+    job_arg = arg;
+    job_rows = rows;
+    remaining = thread_count;
+    job++;
+    pthread_cond_broadcast(&job_ready);
+    pthread_mutex_unlock(&lock);
+
+    task(arg, 0, band_start(rows, 1));
+
+    pthread_mutex_lock(&lock);
+    while(remaining > 0)
+    {
+        pthread_cond_wait(&job_done, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * @brief stops the threads of the pool and waits for them to exit
+ */
+void stop_pool(void)
+{
+    int i;
+
+    pthread_mutex_lock(&lock);
+    stopping = 1;
+    pthread_cond_broadcast(&job_ready);
+    pthread_mutex_unlock(&lock);
+    for(i = 0; i < thread_count; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    /*the threads of a new pool start waiting for job 1, so the last task is not run again*/
+    thread_count = 0;
+    stopping = 0;
+    job = 0;
+    remaining = 0;
+    job_task = NULL;
+    job_arg = NULL;
+}
+
+/**
+ * @brief reads a -j jobs option given as the first arguments and removes it from the arguments. the
+ * number of jobs is 1 if the option is not given
+ * @param argc the number of arguments, which is reduced by 2 if the option was given
+ * @param argv the arguments
+ * @param jobs set to the number of jobs
+ * @return 0 if the option was not given or is valid otherwise 1
+ */
+int read_jobs_option(int *argc, char *argv[], int *jobs)
+{
+    int i;
+
+    *jobs = 1;
+    if(*argc < 3 || strcmp(argv[1], "-j") != 0) return 0;
+
+    *jobs = atoi(argv[2]);
+    if(*jobs < 1 || *jobs > POOL_MAX_THREADS)
+    {
+        fprintf(stderr, "Jobs value is out of range. Range is 1 to %d. Value given: %s\n", POOL_MAX_THREADS, argv[2]);
+        return 1;
+    }
+
+    /*moves the rest of the arguments, and the NULL after them, over the option*/
+    for(i = 3; i <= *argc; i++)
+    {
+        argv[i - 2] = argv[i];
+    }
+    *argc -= 2;
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef POOL_H
+#define POOL_H
+
+/**
+ * function prototypes for a pool of threads that splits work on the rows of an image into bands,
+ * one band for each thread
+ * @author Alex Cole
+ */
+
+/*most threads a pool can have, counting the thread that calls run_rows*/
+#define POOL_MAX_THREADS 64
+
+/*function that does the work for rows start to end - 1. arg is the argument given to run_rows*/
+typedef void (*rows_task_t)(void *arg, int start, int end);
+
+/**
+ * @brief starts a pool of threads that run_rows splits rows between. the calling thread is one of the
+ * threads, so threads - 1 threads are created. if a thread can not be created the pool uses the threads
+ * that were created
+ * @param threads the number of threads to split rows between
+ */
+void start_pool(int threads);
+
+/**
+ * @brief runs a task on rows 0 to rows - 1, giving each thread of the pool a band of rows, and waits
+ * for every band to be done. without a pool the task is run on all of the rows by the calling thread
+ * @param task the function that does the work for a band of rows
+ * @param arg the argument given to task
+ * @param rows the number of rows
+ */
+void run_rows(rows_task_t task, void *arg, int rows);
+
+/**
+ * @brief stops the threads of the pool and waits for them to exit
+ */
+void stop_pool(void);
+
+/**
+ * @brief reads a -j jobs option given as the first arguments and removes it from the arguments. the
+ * number of jobs is 1 if the option is not given
+ * @param argc the number of arguments, which is reduced by 2 if the option was given
+ * @param argv the arguments
+ * @param jobs set to the number of jobs
+ * @return 0 if the option was not given or is valid otherwise 1
+ */
+int read_jobs_option(int *argc, char *argv[], int *jobs);
+
+#endif
@@ -14,22 +14,51 @@ struct pixel
 };
 typedef struct pixel pixel_t;
 
-/*struct to store simp file info*/
+/*pixel buffers start on a boundary of this many bytes so rows can be read with vector loads*/
+#define SIMP_ALIGNMENT 64
+
+/*struct to store simp file info. the pixels are stored in one buffer where row i starts at
+data + i * stride. pixels has a pointer to the start of each row for code that indexes by row.
+mapped is the length of block if block is a simp file mapped into memory, otherwise it is 0. when
+block is NULL the image is a view of part of another image's pixels, which it does not own, and
+pixels is NULL*/
 struct simp
 {
     int width;
     int height;
+    int stride;
+    pixel_t *data;
     pixel_t **pixels;
+    void *block;
+    size_t mapped;
 };
 typedef struct simp simp_t;
 
+/*bytes of pixels in each band of rows a simp stream is read or written in*/
+#define SIMP_BAND_SIZE (1 << 22)
+
+/*struct to read or write a simp file one band of rows at a time. row is the next row to be read or
+written. when an existing file is written, the rows are written to tempname, a new file made with
+mkstemp next to it, until the stream is closed*/
+struct simp_stream
+{
+    FILE *file;
+    char *filename;
+    char *tempname;
+    int width;
+    int height;
+    int row;
+};
+typedef struct simp_stream simp_stream_t;
+
 /**
  * @brief writes a byte array to a file
  * @param ofp file the byte array is to be written to
  * @param bytes array of bytes
  * @size size of the byte array
+ * @return 0 if all of the bytes were written otherwise 1
  */
-void write_byte_array(FILE *ofp, unsigned char bytes[], int size);
+int write_byte_array(FILE *ofp, unsigned char bytes[], int size);
 
 /**
  * @brief sets the pixel color to the given color
@@ -38,6 +67,16 @@ void write_byte_array(FILE *ofp, unsigned char bytes[], int size);
  */
 void set_pixel_color(unsigned char *color, unsigned char *givencolor);
 
+/**
+ * @brief reads the width and height at the start of a simp file
+ * @param in simp file positioned at the start
+ * @param filename name of the simp file
+ * @param width where the width is stored
+ * @param height where the height is stored
+ * @return 0 if the width and height were read otherwise 1 if an error occurred
+ */
+int read_simp_header(FILE *in, char *filename, int *width, int *height);
+
 /**
  * @brief reads simp file and stores info into simp struct
  * @param filename name of the simp file
@@ -47,10 +86,30 @@ void set_pixel_color(unsigned char *color, unsigned char *givencolor);
 int read_simp_file(char* filename, simp_t *image);
 
 /**
- * @brief mallocs space for the pixels
+ * @brief maps a simp file into memory so its pixels can be changed where they are stored in the file.
+ * the changes are in the file once the pixels are freed
+ * @param filename name of the simp file
+ * @param image where the file data is to be stored. the rows are only reached through data and
+ * stride, so pixels is set to NULL
+ * @return 0 if the file was successfully mapped otherwise 1 if an error occurred
+ */
+int map_simp_file(char *filename, simp_t *image);
+
+/**
+ * @brief mallocs space for the pixels with one allocation that holds an aligned pixel buffer and
+ * the row pointers into it
+ * @param image simp file data storage structure with the width and height set
+ * @return 0 if the pixels were allocated otherwise 1 if there was not enough memory
+ */
+int allocate_pixels(simp_t *image);
+
+/**
+ * @brief gets a row of pixels
  * @param image simp file data storage structure
+ * @param row the row to get
+ * @return pointer to the first pixel in the row
  */
-void allocate_pixels(simp_t *image);
+pixel_t* simp_row(simp_t *image, int row);
 
 /**
  * @brief fills in simp struct pixel data from the simp file
@@ -65,11 +124,95 @@ int fill_pixels(FILE *ifp, char *filename, simp_t *image);
  * @brief writes simp struct data to a file
  * @param filename name of the simp file to be written to
  * @param image simp file data storage structure
+ * @return 0 if the file was successfully written otherwise 1 if an error occurred
+ */
+int write_simp_file(char* filename, simp_t *image);
+
+/**
+ * @brief opens a simp file to be read a band of rows at a time
+ * @param filename name of the simp file
+ * @param stream stream to be opened
+ * @return 0 if the file was opened otherwise 1 if an error occurred
+ */
+int open_simp_reader(char *filename, simp_stream_t *stream);
+
+/**
+ * @brief opens a simp file to be written a band of rows at a time. if the file already exists the
+ * rows are written to a temporary file that replaces it when the stream is closed, so the file can
+ * also be the file being read
+ * @param filename name of the simp file
+ * @param stream stream to be opened
+ * @param width width of the image
+ * @param height height of the image
+ * @return 0 if the file was opened otherwise 1 if an error occurred
+ */
+int open_simp_writer(char *filename, simp_stream_t *stream, int width, int height);
+
+/**
+ * @brief mallocs a band of rows that holds about SIMP_BAND_SIZE bytes of pixels
+ * @param width width of the rows
+ * @param height height of the image, which the band does not exceed
+ * @param band simp file data storage structure for the band
+ * @return 0 if the band was allocated otherwise 1 if there was not enough memory
+ */
+int allocate_band(int width, int height, simp_t *band);
+
+/**
+ * @brief reads the next rows of a simp file into a band
+ * @param stream stream being read
+ * @param band band the rows are stored in. its height is set to the number of rows read
+ * @param rows number of rows to read, which is reduced to the rows left in the file
+ * @return 0 if the rows were read otherwise 1 if an error occurred
+ */
+int read_simp_rows(simp_stream_t *stream, simp_t *band, int rows);
+
+/**
+ * @brief reads some of the columns of the next rows of a simp file into a band, seeking past the
+ * other columns, so only the part of a wide image that is used is kept in memory
+ * @param stream stream being read
+ * @param band band the rows are stored in. its width is the number of columns read and its height is
+ * set to the number of rows read
+ * @param rows number of rows to read, which is reduced to the rows left in the file
+ * @param x the first column to read
+ * @return 0 if the rows were read otherwise 1 if an error occurred
+ */
+int read_simp_columns(simp_stream_t *stream, simp_t *band, int rows, int x);
+
+/**
+ * @brief skips over the next rows of a simp file
+ * @param stream stream being read
+ * @param rows number of rows to skip
+ * @return 0 if the rows were skipped otherwise 1 if an error occurred
  */
-void write_simp_file(char* filename, simp_t *image);
+int skip_simp_rows(simp_stream_t *stream, int rows);
 
 /**
- * @brief crops a simp image
+ * @brief writes every row of a band as the next rows of a simp file
+ * @param stream stream being written
+ * @param band band of rows to write
+ * @return 0 if the rows were written otherwise 1 if an error occurred
+ */
+int write_simp_rows(simp_stream_t *stream, simp_t *band);
+
+/**
+ * @brief closes a simp file that was being read
+ * @param stream stream to be closed
+ */
+void close_simp_reader(simp_stream_t *stream);
+
+/**
+ * @brief closes a simp file that was being written. the file is removed if there was an error or
+ * not every row was written, and an existing file that was being replaced is kept
+ * @param stream stream to be closed
+ * @param error non-zero if there was an error while writing the file
+ * @return 0 if the file was written otherwise 1
+ */
+int close_simp_writer(simp_stream_t *stream, int error);
+
+/**
+ * @brief crops a simp image without copying it. the cropped image is a view of the pixels of the
+ * original image, with the stride of the original image, so it is only valid while the original image
+ * is and changing it changes the original image. use copy_simp to get a cropped image of its own
  * @param width resulting cropped image width
  * @param height resulting cropped image height
  * @param x position to begin crop
@@ -80,7 +223,17 @@ void write_simp_file(char* filename, simp_t *image);
 void crop_simp(int width, int height, int x, int y, simp_t *image, simp_t *cropimage);
 
 /**
- * @brief converts a simp image to black and white
+ * @brief copies a simp image, or a view of one, into new pixels that it owns. the rows are split
+ * between the threads of the pool
+ * @param image the simp image to copy
+ * @param copy simp image data structure to store the copy, which must be freed with free_pixels
+ * @return 0 if the image was copied otherwise 1 if there was not enough memory
+ */
+int copy_simp(simp_t *image, simp_t *copy);
+
+/**
+ * @brief converts a simp image to black and white. the pixels are converted with vector instructions
+ * when the cpu supports them, and the rows are split between the threads of the pool
  * @param image simp file data structure to be converted
  */
 void simp2bw(simp_t *image);
@@ -116,6 +269,23 @@ void swap(unsigned char *first, unsigned char *second);
  */
 void swap2colors(simp_t *image, int first, int second);
 
+/**
+ * @brief gets the channel each color channel is shifted from for a given pattern
+ * @param pattern pixel color shift
+ * @param order where channel i of a shifted pixel comes from channel order[i]
+ * @return 0 if the pattern is valid and 1 if the pattern given is invalid
+ */
+int get_colorshift_order(char *pattern, unsigned char order[4]);
+
+/**
+ * @brief shifts colors in a simp image so channel i of each pixel comes from channel order[i]. the
+ * pixels are shuffled with vector instructions when the cpu supports them, and the rows are split
+ * between the threads of the pool
+ * @param image simp file data storage structure
+ * @param order channel order from get_colorshift_order
+ */
+void shift_colors(simp_t *image, unsigned char order[4]);
+
 /**
  * @brief shifts colors in a simp image with given pattern
  * @param pattern pixel color shift
@@ -125,7 +295,10 @@ void swap2colors(simp_t *image, int first, int second);
 int simp_colorshift(char *pattern, simp_t *image);
 
 /**
- * @brief overlays one simp image on top of another simp image at the given initial position
+ * @brief overlays one simp image on top of another simp image at the given initial position. only the
+ * part of the bottom image under the top image is visited, and it is blended with integers, 8 pixels at
+ * a time when the cpu has AVX2, giving the same pixels as combine_color_channels and combine_alpha_channels.
+ * the rows are split between the threads of the pool
  * @param imagebottom bottom image which top image is to be overlaid onto
  * @param imagetop top image that is to be overlaid onto the bottom image
  * @param x start position for top image to be overlaid on bottom image
@@ -152,7 +325,8 @@ double combine_color_channels(int alpha1, int alpha2, int channel1, int channel2
 double combine_alpha_channels(int alpha1, int alpha2);
 
 /**
- * @brief frees the pixel data from the simp struct
+ * @brief frees the pixel data from the simp struct, or unmaps it if it is a mapped simp file. a view
+ * from crop_simp does not own its pixels, so nothing is freed for it
  * @param image simp data storage structure to have pixels freed
  */
 void free_pixels(simp_t *image);
@@ -167,6 +341,18 @@ void free_pixels(simp_t *image);
  */
 int invalid_range(char *name, int value, int max, int min);
 
+/**
+ * @brief checks to see if settings are in valid ranges for an image of a given size
+ * @param x position that should be in range 0 to w-1
+ * @param y position that should be in range 0 to h-1
+ * @param width value that should be in range 1 to w
+ * @param height value that should be in range 1 to h
+ * @param imagewidth the width of the image, w
+ * @param imageheight the height of the image, h
+ * @return 0 if all values are within range otherwise 1 if at least 1 value is not in range
+ */
+int check_ranges(int x, int y, int width, int height, int imagewidth, int imageheight);
+
 /**
  * @brief checks to see if settings are in valid simp file ranges
  * @param x position that should be in range 0 to w-1
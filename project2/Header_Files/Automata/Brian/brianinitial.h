@@ -59,6 +59,13 @@ public:
      *              A string representation of brian initial struct.
      */
     virtual string toString();
+
+    /**
+     * Creates a copy of the brian initial.
+     * @return
+     *              The copy, which must be deleted by the caller.
+     */
+    virtual Initial* clone() const;
 };
 
 #endif
@@ -59,6 +59,37 @@ public:
      */
     virtual State nextCellState(vector<vector<Cell>> &world, Cell &cell);
 
+    /**
+     * Finds the cells in the given rows that will change state in the next generation.
+     * @param world
+     *              The grid of cells with a border of ghost cells around it.
+     * @param rowStart
+     *              The first row to check, not counting the ghost border.
+     * @param rowEnd
+     *              The row after the last row to check, not counting the ghost border.
+     * @param cells
+     *              The cell vector the changed cells are added to, with their positions not counting
+     *              the ghost border.
+     */
+    virtual void findChangedCells(vector<vector<Cell>> &world, int rowStart, int rowEnd, vector<Cell> &cells);
+
+    /**
+     * Sets the next state of each cell in a region of a grid in another grid of the same size.
+     * @param world
+     *              The grid of cells. Every neighbor of the region must be in the grid.
+     * @param next
+     *              The grid the next states are set in.
+     * @param rowStart
+     *              The first row of the region.
+     * @param rowEnd
+     *              The row after the last row of the region.
+     * @param colStart
+     *              The first column of the region.
+     * @param colEnd
+     *              The column after the last column of the region.
+     */
+    virtual void nextStates(vector<vector<Cell>> &world, vector<vector<Cell>> &next, int rowStart, int rowEnd, int colStart, int colEnd);
+
     /**
      * Gets the char representation of the state of the given cell.
      * @param cell
@@ -84,6 +115,13 @@ public:
      */
     virtual string toString();
 
+    /**
+     * Creates a copy of the automaton with the same type.
+     * @return
+     *              The copy, which must be deleted by the caller.
+     */
+    virtual CellularAutomaton* clone() const;
+
 private:
     /**
      * Gets the bit value in an unsigned char at the given position.
@@ -98,7 +136,7 @@ private:
 
     /**
      * Creates a string rule pattern based on the state of the 3 cells
-     * above the given cell (accounts for wrap around).
+     * above the given cell (wrap around comes from the ghost cells).
      * @param world
      *              The grid of cells to compare the cell to its neighbors.
      * @param cell
@@ -60,6 +60,13 @@ public:
      *              A string representation of elementary initial struct.
      */
     virtual string toString();
+
+    /**
+     * Creates a copy of the elementary initial.
+     * @return
+     *              The copy, which must be deleted by the caller.
+     */
+    virtual Initial* clone() const;
 };
 
 #endif
@@ -68,6 +68,37 @@ public:
      */
     virtual State nextCellState(vector<vector<Cell>> &world, Cell &cell);
 
+    /**
+     * Finds the cells in the given rows that will change state in the next generation.
+     * @param world
+     *              The grid of cells with a border of ghost cells around it.
+     * @param rowStart
+     *              The first row to check, not counting the ghost border.
+     * @param rowEnd
+     *              The row after the last row to check, not counting the ghost border.
+     * @param cells
+     *              The cell vector the changed cells are added to, with their positions not counting
+     *              the ghost border.
+     */
+    virtual void findChangedCells(vector<vector<Cell>> &world, int rowStart, int rowEnd, vector<Cell> &cells);
+
+    /**
+     * Sets the next state of each cell in a region of a grid in another grid of the same size.
+     * @param world
+     *              The grid of cells. Every neighbor of the region must be in the grid.
+     * @param next
+     *              The grid the next states are set in.
+     * @param rowStart
+     *              The first row of the region.
+     * @param rowEnd
+     *              The row after the last row of the region.
+     * @param colStart
+     *              The first column of the region.
+     * @param colEnd
+     *              The column after the last column of the region.
+     */
+    virtual void nextStates(vector<vector<Cell>> &world, vector<vector<Cell>> &next, int rowStart, int rowEnd, int colStart, int colEnd);
+
     /**
      * Gets the char representation of the state of the given cell.
      * @param cell
@@ -93,6 +124,47 @@ public:
      */
     virtual string toString();
 
+    /**
+     * Creates a copy of the automaton with the same type.
+     * @return
+     *              The copy, which must be deleted by the caller.
+     */
+    virtual CellularAutomaton* clone() const;
+
+    /**
+     * Sets the rule with the given rule string and updates the born and stay alive counts.
+     * @param rule
+     *              The rule string in the form B012../S012..
+     * @throws InvalidRuleException
+     *              If the rule is not in valid format (B012../S012..)
+     */
+    virtual void setRule(string rule);
+
+    /**
+     * Sets the rule from bit masks of neighbor counts, where bit n is set if n alive neighbors
+     * cause a cell to be born or stay alive. Unlike a rule read from a file, either mask may be
+     * empty, so every one of the 2^18 life-like rules can be set.
+     * @param bornMask
+     *              The neighbor counts (bits 0-8) that cause a cell to be born.
+     * @param stayAliveMask
+     *              The neighbor counts (bits 0-8) that cause a cell to stay alive.
+     */
+    void setRuleMasks(int bornMask, int stayAliveMask);
+
+    /**
+     * Gets the neighbor counts that cause a cell to be born as a bit mask.
+     * @return
+     *              The mask where bit n is set if n alive neighbors cause a cell to be born.
+     */
+    int getBornMask();
+
+    /**
+     * Gets the neighbor counts that cause a cell to stay alive as a bit mask.
+     * @return
+     *              The mask where bit n is set if n alive neighbors cause a cell to stay alive.
+     */
+    int getStayAliveMask();
+
 private:
     /**
      * Adds values to the born int vector based on the rule string.
@@ -59,6 +59,13 @@ public:
      *              A string representation of life-like initial struct.
      */
     virtual string toString();
+
+    /**
+     * Creates a copy of the life-like initial.
+     * @return
+     *              The copy, which must be deleted by the caller.
+     */
+    virtual Initial* clone() const;
 };
 
 #endif
@@ -29,7 +29,7 @@ public:
      * @param ruleAutomatonStruct
      *              The string rule automaton struct.
      */
-    RuleAutomaton(string ruleAutomatonStruct);
+    RuleAutomaton(const string &ruleAutomatonStruct);
 
     /**
      * Destructor
@@ -57,9 +57,10 @@ public:
      * Determines the next state of a given cell based on the world
      * and neighboring cells.
      * @param world
-     *              The grid of cells.
+     *              The grid of cells, which has a border of ghost cells around it so that every
+     *              neighbor of the cell is in the grid without wrapping around.
      * @param cell
-     *              The cell that the next state needs to be determined.
+     *              The cell that the next state needs to be determined. It is never a ghost cell.
      * @return
      *              The next state of the cell.
      */
@@ -97,7 +98,7 @@ public:
      * @param rule
      *              The rule string to set the rule to.
      */
-    void setRule(string rule);
+    virtual void setRule(string rule);
 
     /**
      * Not implemented.
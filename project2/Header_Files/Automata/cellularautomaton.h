@@ -6,9 +6,12 @@
 #include "colors.h"
 #include "initial.h"
 #include <map>
+#include <memory>
 
 /**
- * abstract class that represents a cellular automaton
+ * abstract class that represents a cellular automaton. Copies of an automaton share its terrain,
+ * window, chars, colors and initial, so copying one does not copy its initial cells. A copy only
+ * makes its own terrain, window or initial when it changes them through the update functions.
  * @author Alex Cole
  */
 class CellularAutomaton
@@ -17,27 +20,27 @@ private:
     /**
      * The terrain of the automaton
      */
-    Range* terrain;
+    shared_ptr<Range> terrain;
 
     /**
      * The window of the automaton
      */
-    Range* window;
+    shared_ptr<Range> window;
 
     /**
      * Character values for the automaton
      */
-    Chars *chars;
+    shared_ptr<Chars> chars;
 
     /**
      * Color values for the automaton
      */
-    Colors *colors;
+    shared_ptr<Colors> colors;
 
     /**
      * Initial cell values for the automaton
      */
-    Initial *initial;
+    shared_ptr<Initial> initial;
 
     /**
      * The name of the automaton
@@ -57,7 +60,7 @@ public:
      * @param automatonStruct
      *          The automaton struct.
      */
-    CellularAutomaton(string automatonStruct);
+    CellularAutomaton(const string &automatonStruct);
 
     /**
      * Destructor
@@ -65,14 +68,15 @@ public:
     virtual ~CellularAutomaton();
 
     /**
-     * Copy constructor.
+     * Copy constructor that shares the terrain, window, chars, colors and initial of the automaton.
      * @param automaton
      *          The automaton to be copied.
      */
     CellularAutomaton(const CellularAutomaton &automaton);
 
     /**
-     * Overloaded assignment operator
+     * Overloaded assignment operator that shares the terrain, window, chars, colors and initial of
+     * the automaton.
      * @param automaton
      *          The automaton to be copied
      * @return
@@ -81,7 +85,8 @@ public:
     CellularAutomaton& operator=(const CellularAutomaton &automaton);
 
     /**
-     * Gets the terrain.
+     * Gets the terrain. The terrain may be shared with copies of the automaton, so it should
+     * only be changed with updateTerrain.
      * @return
      *          A pointer to the terrain.
      */
@@ -109,7 +114,8 @@ public:
     Colors* getColors() const;
 
     /**
-     * Gets the initial.
+     * Gets the initial. The initial may be shared with copies of the automaton, so it should
+     * only be changed with updateInitial.
      * @return
      *          A pointer to the initial.
      */
@@ -123,21 +129,21 @@ public:
     string getName() const;
 
     /**
-     * Sets Chars to the given Chars
+     * Sets Chars to the given Chars, deleting the old Chars once no copy of the automaton uses it.
      * @param chars
      *          The given Chars to set Chars to.
      */
     void setChars(Chars *chars);
 
     /**
-     * Sets Colors to the given Colors
+     * Sets Colors to the given Colors, deleting the old Colors once no copy of the automaton uses it.
      * @param colors
      *          The given Colors to set Colors to.
      */
     void setColors(Colors *colors);
 
     /**
-     * Sets Initial to the given Initial
+     * Sets Initial to the given Initial, deleting the old Initial once no copy of the automaton uses it.
      * @param initial
      *          The given Initial to set Initial to.
      */
@@ -165,6 +171,14 @@ public:
      */
     void updateTerrain(string xRange, string yRange);
 
+    /**
+     * Sets the initial cells to the given world cells converted to terrain positions. A copy of
+     * the initial is made first if it is shared with a copy of the automaton.
+     * @param worldCells
+     *              The cells with world positions.
+     */
+    void updateInitial(vector<Cell> worldCells);
+
     /**
      * Sets the name of the automaton.
      * @param name
@@ -177,14 +191,48 @@ public:
      * Determines the next state of a given cell based on the world
      * and neighboring cells.
      * @param world
-     *              The grid of cells.
+     *              The grid of cells, which has a border of ghost cells around it so that every
+     *              neighbor of the cell is in the grid without wrapping around.
      * @param cell
-     *              The cell that the next state needs to be determined.
+     *              The cell that the next state needs to be determined. It is never a ghost cell.
      * @return
      *              The next state of the cell.
      */
     virtual State nextCellState(vector<vector<Cell>> &world, Cell &cell) = 0;
 
+    /**
+     * Not implemented.
+     * Finds the cells in the given rows that will change state in the next generation.
+     * @param world
+     *              The grid of cells with a border of ghost cells around it.
+     * @param rowStart
+     *              The first row to check, not counting the ghost border.
+     * @param rowEnd
+     *              The row after the last row to check, not counting the ghost border.
+     * @param cells
+     *              The cell vector the changed cells are added to, with their positions not counting
+     *              the ghost border.
+     */
+    virtual void findChangedCells(vector<vector<Cell>> &world, int rowStart, int rowEnd, vector<Cell> &cells) = 0;
+
+    /**
+     * Not implemented.
+     * Sets the next state of each cell in a region of a grid in another grid of the same size.
+     * @param world
+     *              The grid of cells. Every neighbor of the region must be in the grid.
+     * @param next
+     *              The grid the next states are set in.
+     * @param rowStart
+     *              The first row of the region.
+     * @param rowEnd
+     *              The row after the last row of the region.
+     * @param colStart
+     *              The first column of the region.
+     * @param colEnd
+     *              The column after the last column of the region.
+     */
+    virtual void nextStates(vector<vector<Cell>> &world, vector<vector<Cell>> &next, int rowStart, int rowEnd, int colStart, int colEnd) = 0;
+
     /**
      * Not implemented.
      * Gets the char representation of the state of the given cell.
@@ -213,6 +261,15 @@ public:
      */
     virtual string toString() = 0;
 
+    /**
+     * Not implemented.
+     * Creates a copy of the automaton with the same type, sharing its terrain, window, chars,
+     * colors and initial like the copy constructor.
+     * @return
+     *              The copy, which must be deleted by the caller.
+     */
+    virtual CellularAutomaton* clone() const = 0;
+
 protected:
     /**
      * Sets the instance variables to default values.
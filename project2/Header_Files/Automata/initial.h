@@ -99,8 +99,17 @@ public:
      */
     virtual string toString() = 0;
 
+    /**
+     * Not implemented.
+     * Creates a copy of the initial with the same type.
+     * @return
+     *              The copy, which must be deleted by the caller.
+     */
+    virtual Initial* clone() const = 0;
+
     /**
      * Initializes the initial object with a given terrain range and string of cells in the form of (cell, cell, cell,...).
+     * A cell that is already in the initial cells is not added again.
      * @param initialCells
      *              The string of cells.
      * @param terrain
@@ -110,7 +119,7 @@ public:
      * @throws InvalidInitialValueException
      *              If there is a comma missing between cells.
      */
-    void convertCellStr(string initalCells, Range *terrain, State state);
+    void convertCellStr(const string &initialCells, Range *terrain, State state);
 
     /**
      * Converts cells given from a world grid to cells in the automaton terrain.
@@ -139,15 +148,18 @@ private:
      * Gets a cell string in the form of x,y from a string of cells.
      * @param initialCells
      *              The string of cells.
+     * @param pos
+     *              The position to look for the cell from, which is moved past the cell.
      * @return
      *              A string representation of a cell.
      * @throws InvalidInitialValueException
      *              If the cell is missing the left bracket '(' or the right bracket ')'
      */
-    string extractCellStr(string &initialCells);
+    string extractCellStr(const string &initialCells, size_t &pos);
 
     /**
-     * Add cell from a cell string to the initial cells if it is not already in the initial cells.
+     * Add cell from a cell string to the initial cells. Cells that are already in the initial cells
+     * are removed by removeDuplicates.
      * @param cellStr
      *              The cell string.
      * @param terrain
@@ -158,6 +170,15 @@ private:
      *              If the cell string is missing a comma between x and y values.
      */
     void addCellFromCellStr(string &cellStr, Range *terrain, State state);
+
+    /**
+     * Removes the cells added since the given position that are at the same position as an earlier
+     * cell, keeping the order of the rest. The cells are sorted by position to find them, instead of
+     * searching the cells for each new cell.
+     * @param firstNew
+     *              The position of the first cell that was added.
+     */
+    void removeDuplicates(size_t firstNew);
 };
 
 #endif
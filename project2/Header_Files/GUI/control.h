@@ -5,12 +5,14 @@
 #include "world.h"
 #include <QApplication>
 #include <QDialog>
+#include <QElapsedTimer>
 
 class QLabel;
 class QSpinBox;
 class QSlider;
 class QPushButton;
 class QTimer;
+class QProgressBar;
 
 /**
  * control dialog box
@@ -40,7 +42,8 @@ public:
      * @param world
      *              The cellular automaton world.
      * @param generations
-     *              The initial generation.
+     *              The generation to catch up to. The world is simulated towards it in slices so
+     *              the window can be shown right away.
      * @param gridSize
      *              The size of the grid blocks in pixels.
      */
@@ -70,6 +73,11 @@ public:
      */
     void simulateOneGen();
 
+    /**
+     * Stops catching up to the requested generation and discards a partially simulated generation.
+     */
+    void stopCatchUp();
+
 private slots:
     /**
      * Simulates the world by one generation. Does not
@@ -104,6 +112,18 @@ private slots:
      */
     void playSimulation();
 
+    /**
+     * Simulates a slice of the generations that still need to be caught up on, then returns
+     * to the event loop so the window stays responsive.
+     */
+    void catchUp();
+
+    /**
+     * Cancels catching up to the requested generation. The world is left at the last
+     * generation that was completed.
+     */
+    void cancelClicked();
+
 private:
     /**
      * grid size label
@@ -165,11 +185,36 @@ private:
      */
     QPushButton *step;
 
+    /**
+     * cancel button for catching up to the requested generation
+     */
+    QPushButton *cancel;
+
+    /**
+     * progress of catching up to the requested generation
+     */
+    QProgressBar *progress;
+
     /**
      * timer for simulation based on delay
      */
     QTimer *timer;
 
+    /**
+     * timer that keeps catching up to the requested generation while the event loop is idle
+     */
+    QTimer *catchUpTimer;
+
+    /**
+     * time in milliseconds since the last interim frame was shown while catching up
+     */
+    QElapsedTimer frameTimer;
+
+    /**
+     * the generation being caught up to
+     */
+    int catchUpTarget;
+
     /**
      * world of the automaton
      */
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <string>
+#include <ostream>
 
 using namespace std;
 
@@ -30,7 +31,7 @@ public:
     /**
      * Parses automaton file into key-value pairs. The key is the
      * identifier and the value could be a struct or other value specified after
-     * the identifier.
+     * the identifier. The input is read in place, so only the values are copied.
      * @param input
      *              The automaton file with all comments and whitespace removed.
      * @return
@@ -38,7 +39,7 @@ public:
      * @throws InvalidFileFormatException
      *              If the file is not properly formatted.
      */
-    static map<string, string> parse(string input);
+    static map<string, string> parse(const string &input);
 
     /**
      * Gets the value from the map based on the key identifier.
@@ -49,106 +50,94 @@ public:
      * @param checkValue
      *              If the value of the identifier should be checked. Default is false.
      * @return
-     *              The value of the key-value pair based on the given identifier.
+     *              The value of the key-value pair based on the given identifier, which stays
+     *              in the map.
      * @throws MissingIdentifierException
      *              If the given key identifier is not in the map.
      * @throws IdentifierHasNoValueException
      *              If checkValue is true and the key identifier does not have a value.
      */
-    static string getValue(map<string, string> &map, string identifier, bool checkValue = false);
+    static const string& getValue(map<string, string> &map, string identifier, bool checkValue = false);
 
-private:
     /**
-     * Checks to see if the input has a key.
-     * @param input
-     *              The string input.
+     * Gets the value from the map based on the key identifier and removes it from the map
+     * without copying it, so a large value such as the initial cells is only stored once.
+     * @param map
+     *              The map of key-value pairs.
+     * @param identifier
+     *              The key identifier.
+     * @param checkValue
+     *              If the value of the identifier should be checked. Default is false.
      * @return
-     *              True if there is a key otherwise false.
+     *              The value of the key-value pair based on the given identifier.
+     * @throws MissingIdentifierException
+     *              If the given key identifier is not in the map.
+     * @throws IdentifierHasNoValueException
+     *              If checkValue is true and the key identifier does not have a value.
      */
-    static bool hasKey(string input);
+    static string takeValue(map<string, string> &map, string identifier, bool checkValue = false);
 
     /**
-     * Checks to see if the value is in correct automaton file format.
-     * @param str
-     *              The portion of the automaton file to be checked.
+     * Gets the stream problems found while reading settings and automata are reported to. It is cerr
+     * unless the calling thread has set its own stream with setErrors.
      * @return
-     *              True if in proper format otherwise false.
+     *              The error stream of the calling thread.
      */
-    static bool properFormat(string str);
+    static ostream& errors();
 
     /**
-     * Counts the number of characters in a string.
-     * @param str
-     *              The string that the characters are going to be counted.
-     * @param ch
-     *              The character to count.
+     * Sets the stream problems found while reading settings and automata on the calling thread are
+     * reported to, so jobs run on different threads each keep their own errors.
+     * @param err
+     *              The stream to report to, or NULL for cerr.
      * @return
-     *              The number of the given character in the string.
+     *              The stream that was set before, or NULL if it was cerr.
      */
-    static int countChar(string str, char ch);
+    static ostream* setErrors(ostream *err);
 
+private:
     /**
-     * Checks to see if file has a terminating character for each initial character.
-     * @param arr
-     *              The positions of the initial characters.
-     * @param length
-     *              The length of the array.
+     * Checks to see if the value is in correct automaton file format, which is when every
+     * { and = outside of quotes has a matching } and ;.
      * @param str
-     *              The string that the format needs to be checked.
-     * @param start
-     *              The initial character.
-     * @param end
-     *              The terminating character.
+     *              The portion of the automaton file to be checked.
      * @return
-     *              True if in correct format otherwise false.
+     *              True if in proper format otherwise false.
      */
-    static bool checkFormat(int *arr, int length, string str, char start, char end);
+    static bool properFormat(const string &str);
 
     /**
-     * Finds the terminating character to the given start character.
+     * Finds the terminating character to the first start character in part of a string.
      * @param str
      *              The string to be checked.
+     * @param begin
+     *              The position of the start of the part.
+     * @param finish
+     *              The position after the end of the part.
      * @param start
      *              The starting character.
      * @param end
      *              The terminating character.
      * @return
-     *              The position of the terminating character otherwise -1.
+     *              The position of the terminating character otherwise string::npos.
      */
-    static int findMatchingCharPos(string str, char start, char end);
+    static size_t findMatchingCharPos(const string &str, size_t begin, size_t finish, char start, char end);
 
     /**
-     * Finds the starting character position in the array for a terminating character.
-     * @param arr
-     *              An array of starting positions.
-     * @param length
-     *              The length of the array.
-     * @return
-     *              The position of the corresponding start character otherwise -1.
-     */
-    static int findMatchingCharPos(int *arr, int length);
-
-    /**
-     * Removes a quoted string from the string.
-     * @param str
-     *              The string to have the quote removed from.
-     * @return
-     *              A string with no quoted strings in it.
-     */
-    static string removeQuotedStr(string str);
-
-    /**
-     * Removes starting and terminating characters from a string.
+     * Moves the bounds of part of a string inside of starting and terminating characters
+     * if the part starts and ends with them.
      * @param str
-     *              The string to have the characters removed.
+     *              The string the part is in.
+     * @param begin
+     *              The position of the start of the part.
+     * @param finish
+     *              The position after the end of the part.
      * @param start
      *              The start character to be removed.
      * @param end
      *              The end character to be removed.
-     * @return
-     *              The string with the starting and terminating characters removed.
      */
-    static string removeChar(string str, char start, char end);
+    static void removeChar(const string &str, size_t &begin, size_t &finish, char start, char end);
 };
 
 #endif
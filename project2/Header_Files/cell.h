@@ -48,16 +48,17 @@ public:
     Cell(int x, int y, State state);
 
     /**
-     * Copy constructor.
+     * Copy constructor. The copy constructor, destructor and assignment operator are the defaults,
+     * so a row of cells is copied as one block of memory.
      * @param cell
      *          The cell to be copied.
      */
-    Cell(const Cell &cell);
+    Cell(const Cell &cell) = default;
 
     /**
      * Destructor
      */
-    ~Cell();
+    ~Cell() = default;
 
     /**
      * Overloaded assignment operator.
@@ -66,28 +67,28 @@ public:
      * @return
      *          A copy of the given cell.
      */
-    Cell& operator=(const Cell &cell);
+    Cell& operator=(const Cell &cell) = default;
 
     /**
      * Gets the x position.
      * @return
      *          The x value.
      */
-    int getX();
+    int getX() const;
 
     /**
      * Gets the y position.
      * @return
      *          The y value.
      */
-     int getY();
+     int getY() const;
 
     /**
      * Gets the state.
      * @return
      *          The state of the cell.
      */
-    State getState();
+    State getState() const;
 
     /**
      * Sets the x position.
@@ -128,4 +129,27 @@ public:
     string toString();
 };
 
+/*
+ * The accessors used for every cell of every generation are defined here so they can be inlined.
+ */
+inline int Cell::getX() const
+{
+    return x;
+}
+
+inline int Cell::getY() const
+{
+    return y;
+}
+
+inline State Cell::getState() const
+{
+    return state;
+}
+
+inline void Cell::setState(State state)
+{
+    this->state = state;
+}
+
 #endif
@@ -0,0 +1,161 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Class that simulates up to 64 Life-like worlds with the same rule and terrain size at once. Each
+ * cell is stored as a 64 bit word where bit k is set if the cell is alive in instance k, so one pass of
+ * boolean neighbor counting over the words advances every instance by a generation. The terrain wraps
+ * around the same way it does in World.
+ * @author Alex Cole
+ */
+class Ensemble
+{
+public:
+    /**
+     * The most instances an ensemble can hold, one for each bit of a cell word.
+     */
+    static const int MaxInstances = 64;
+
+private:
+    /**
+     * The number of rows in each instance.
+     */
+    int rows;
+
+    /**
+     * The number of columns in each instance.
+     */
+    int columns;
+
+    /**
+     * The number of instances added.
+     */
+    int instances;
+
+    /**
+     * Bit n is set if n alive neighbors cause a cell to be born.
+     */
+    int bornMask;
+
+    /**
+     * Bit n is set if n alive neighbors cause a cell to stay alive.
+     */
+    int stayAliveMask;
+
+    /**
+     * The cell words in row major order.
+     */
+    vector<unsigned long long> cells;
+
+    /**
+     * The cell words of the next generation while it is being found.
+     */
+    vector<unsigned long long> nextCells;
+
+public:
+    /**
+     * Constructor that creates an ensemble with no instances.
+     * @param rows
+     *          The number of rows in each instance.
+     * @param columns
+     *          The number of columns in each instance.
+     * @param bornMask
+     *          Bit n is set if n alive neighbors cause a cell to be born.
+     * @param stayAliveMask
+     *          Bit n is set if n alive neighbors cause a cell to stay alive.
+     */
+    Ensemble(int rows, int columns, int bornMask, int stayAliveMask);
+
+    /**
+     * Destructor
+     */
+    ~Ensemble();
+
+    /**
+     * Adds an instance with all cells dead.
+     * @return
+     *          The index of the instance or -1 if the ensemble is full.
+     */
+    int addInstance();
+
+    /**
+     * Gets the number of instances.
+     * @return
+     *          The number of instances.
+     */
+    int size();
+
+    /**
+     * Sets a cell to alive in an instance.
+     * @param instance
+     *          The index of the instance.
+     * @param row
+     *          The row of the cell.
+     * @param col
+     *          The column of the cell.
+     */
+    void setAlive(int instance, int row, int col);
+
+    /**
+     * Checks if a cell is alive in an instance.
+     * @param instance
+     *          The index of the instance.
+     * @param row
+     *          The row of the cell.
+     * @param col
+     *          The column of the cell.
+     * @return
+     *          True if the cell is alive otherwise false.
+     */
+    bool isAlive(int instance, int row, int col);
+
+    /**
+     * Simulates one generation of every instance.
+     */
+    void step();
+
+    /**
+     * Gets the instances that have at least one alive cell.
+     * @return
+     *          A word where bit k is set if instance k has an alive cell.
+     */
+    unsigned long long aliveInstances();
+
+    /**
+     * Gets the population of every instance.
+     * @param populations
+     *          Filled with the number of alive cells in each instance.
+     */
+    void getPopulations(vector<int> &populations);
+
+private:
+    /**
+     * Gets a word that has the bits of the instances that are in use set.
+     * @return
+     *          The word with the bit of each instance set.
+     */
+    unsigned long long activeInstances();
+
+    /**
+     * Gets the instances whose neighbor count is in a mask of counts.
+     * @param counts
+     *          Bit n is set if a count of n matches.
+     * @param s0
+     *          Bit 0 of the neighbor count of each instance.
+     * @param s1
+     *          Bit 1 of the neighbor count of each instance.
+     * @param s2
+     *          Bit 2 of the neighbor count of each instance.
+     * @param s3
+     *          Bit 3 of the neighbor count of each instance.
+     * @return
+     *          A word where bit k is set if the neighbor count of instance k is in the mask.
+     */
+    static unsigned long long countIn(int counts, unsigned long long s0, unsigned long long s1, unsigned long long s2, unsigned long long s3);
+};
+
+#endif
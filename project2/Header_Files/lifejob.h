@@ -0,0 +1,70 @@
+#ifndef LIFEJOB_H
+#define LIFEJOB_H
+
+#include <iostream>
+#include "settings.h"
+#include "cellularautomaton.h"
+
+/**
+ * Class that runs what life does for one set of settings: reads and parses the automaton file,
+ * creates the world, simulates it and prints it. Each job has its own automaton and world, so
+ * separate jobs can be run at the same time on different threads.
+ * @author Alex Cole
+ */
+class LifeJob
+{
+private:
+    /**
+     * The settings for the job.
+     */
+    Settings settings;
+
+public:
+    /**
+     * Constructor that takes in the settings for the job.
+     * @param settings
+     *          The settings for the job. Input is read from standard in if no file is given.
+     */
+    LifeJob(const Settings &settings);
+
+    /**
+     * Destructor
+     */
+    ~LifeJob();
+
+    /**
+     * Runs the job, writing the world in the format given by the settings to out, exactly as life
+     * prints it, and writing stats if -stats was given.
+     * @param out
+     *          The stream the world is printed to.
+     * @param err
+     *          The stream problems with the job are reported to.
+     * @return
+     *          0 if the job was successful otherwise -1.
+     */
+    int run(ostream &out, ostream &err);
+
+    /**
+     * Reads and parses the automaton file and applies the terrain and window ranges from the settings.
+     * @param err
+     *          The stream problems with the file are reported to.
+     * @return
+     *          The automaton, which must be deleted by the caller, or NULL if the file could not be read
+     *          or does not contain a cellular automaton.
+     * @throws InvalidFileFormatException
+     *          If the file is not in valid life file format.
+     */
+    CellularAutomaton* createAutomaton(ostream &err);
+
+private:
+    /**
+     * Reads the automaton file or standard in if no file was given.
+     * @param err
+     *          The stream problems are reported to.
+     * @return
+     *          0 if the input was read successfully otherwise -1.
+     */
+    int readInput(ostream &err);
+};
+
+#endif
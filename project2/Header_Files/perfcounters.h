@@ -0,0 +1,102 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+/**
+ * Hardware counter values read for one measured section.
+ */
+struct PerfSample
+{
+    long long cycles;
+    long long instructions;
+    long long cacheMisses;
+    long long branchMisses;
+};
+
+/**
+ * Class that measures sections of code with a group of hardware performance counters (cycles,
+ * instructions, cache misses and branch misses) opened with perf_event_open. The counters are
+ * only counted for this process in user space. If the counters cannot be opened, for example in a
+ * container or when the kernel does not allow it, the counters are unavailable and nothing is
+ * measured.
+ * @author Alex Cole
+ */
+class PerfCounters
+{
+private:
+    /**
+     * The number of counters in the group.
+     */
+    static const int NumCounters = 4;
+
+    /**
+     * The file descriptors of the counters. The first is the group leader. -1 if not opened.
+     */
+    int fds[NumCounters];
+
+public:
+    /**
+     * Default constructor that opens the counter group.
+     */
+    PerfCounters();
+
+    /**
+     * Destructor that closes the counter group.
+     */
+    ~PerfCounters();
+
+    /**
+     * Checks if the counters could be opened.
+     * @return
+     *          True if the counters are available otherwise false.
+     */
+    bool isAvailable();
+
+    /**
+     * Resets the counters and starts counting.
+     */
+    void start();
+
+    /**
+     * Stops counting and reads the counters.
+     * @param sample
+     *          The sample the counter values are read into.
+     * @return
+     *          True if the counters were read otherwise false.
+     */
+    bool stop(PerfSample &sample);
+
+private:
+    /**
+     * Copy constructor that is not allowed, since the counters cannot be shared.
+     * @param counters
+     *          The counters to copy.
+     */
+    PerfCounters(const PerfCounters &counters);
+
+    /**
+     * Assignment operator that is not allowed, since the counters cannot be shared.
+     * @param counters
+     *          The counters to copy.
+     * @return
+     *          This object.
+     */
+    PerfCounters& operator=(const PerfCounters &counters);
+
+    /**
+     * Opens one hardware counter.
+     * @param config
+     *          The hardware event to count.
+     * @param groupFd
+     *          The file descriptor of the group leader or -1 to open the leader.
+     * @return
+     *          The file descriptor of the counter or -1 if it could not be opened.
+     */
+    static int openCounter(unsigned long long config, int groupFd);
+
+    /**
+     * Closes all the counters that are open.
+     */
+    void close();
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef RULESWEEP_H
+#define RULESWEEP_H
+
+#include "ruleautomaton.h"
+
+/**
+ * Summary of how a world behaved under one rule.
+ */
+struct RuleSummary
+{
+    /**
+     * The number of the rule in the sweep.
+     */
+    int rule;
+
+    /**
+     * The rule as it would be written in an automaton file.
+     */
+    string ruleStr;
+
+    /**
+     * The population when the simulation stopped.
+     */
+    int population;
+
+    /**
+     * The period of the cycle the world ended in, 1 if it became static or died, 0 if no cycle was found.
+     */
+    int period;
+
+    /**
+     * The first generation of the cycle the world ended in, -1 if no cycle was found.
+     */
+    int stabilised;
+
+    /**
+     * The number of generations that were simulated.
+     */
+    int generations;
+};
+
+/**
+ * Class that simulates one parsed automaton under different rules. The rules of an Elementary
+ * automaton are numbered 0-255 and the rules of a Life-like automaton are numbered 0-262143, where
+ * bits 0-8 are the born mask and bits 9-17 are the stay alive mask. Each rule is simulated on its own
+ * copy of the automaton, so rules can be run at the same time on different threads.
+ * @author Alex Cole
+ */
+class RuleSweep
+{
+private:
+    /**
+     * The parsed automaton, which is not changed or deleted by the sweep.
+     */
+    RuleAutomaton *automaton;
+
+    /**
+     * True if the automaton is Life-like otherwise it is Elementary.
+     */
+    bool life;
+
+    /**
+     * The most generations simulated for a rule.
+     */
+    int maxGenerations;
+
+public:
+    /**
+     * Constructor that takes in the automaton to sweep.
+     * @param automaton
+     *          The Life-like or Elementary automaton that gives the terrain and initial cells.
+     * @param maxGenerations
+     *          The most generations simulated for a rule.
+     * @throws InvalidRuleException
+     *          If the automaton is not Life-like or Elementary.
+     */
+    RuleSweep(RuleAutomaton *automaton, int maxGenerations);
+
+    /**
+     * Destructor that does not delete the automaton.
+     */
+    ~RuleSweep();
+
+    /**
+     * Gets the number of rules for the automaton.
+     * @return
+     *          256 for Elementary or 262144 for Life-like.
+     */
+    int numRules();
+
+    /**
+     * Simulates the automaton under a rule until it dies, becomes static, repeats an earlier
+     * generation or reaches the most generations.
+     * @param rule
+     *          The number of the rule.
+     * @return
+     *          The summary of the simulation.
+     */
+    RuleSummary run(int rule);
+};
+
+#endif
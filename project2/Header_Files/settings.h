@@ -28,11 +28,21 @@ class Settings
      */
     bool control;
 
+    /**
+     * hardware counter switch
+     */
+    bool perf;
+
     /**
      * generation switch
      */
     int generations;
 
+    /**
+     * generations per tile switch
+     */
+    int blockDepth;
+
     /**
      * grid size switch
      */
@@ -58,6 +68,11 @@ class Settings
      */
     string wy;
 
+    /**
+     * stats file switch
+     */
+    string statsFile;
+
     /**
      * automaton file
      */
@@ -68,6 +83,11 @@ class Settings
      */
     string input;
 
+    /**
+     * bytes of a mapped file read before the pages are given back
+     */
+    static const size_t ReleaseSize = 64 << 20;
+
 public:
     /**
      * Default constructor that sets the values to default values.
@@ -111,6 +131,13 @@ public:
      */
     bool controlFlag();
 
+    /**
+     * Gets the hardware counter flag setting.
+     * @return
+     *          True if set otherwise false.
+     */
+    bool perfFlag();
+
     /**
      * Gets the file format setting.
      * @return
@@ -125,6 +152,13 @@ public:
      */
     int getGenerations();
 
+    /**
+     * Gets the number of generations simulated at a time on each tile of the world.
+     * @return
+     *          1 by default otherwise the number -block was set to.
+     */
+    int getBlockDepth();
+
     /**
      * Gets the grid size.
      * @return
@@ -160,6 +194,13 @@ public:
      */
     string getWY();
 
+    /**
+     * Gets the name of the file stats are written to.
+     * @return
+     *          The name of the stats file or an empty string if -stats was not given.
+     */
+    string getStatsFile();
+
     /**
      * Gets the name of the file.
      * @return
@@ -172,7 +213,23 @@ public:
      * @return
      *          The contents of the file.
      */
-    string getInput();
+    const string& getInput();
+
+    /**
+     * Frees the content of the file once it has been parsed.
+     */
+    void clearInput();
+
+    /**
+     * Reads a file and removes whitespace and comments from it. A regular file is mapped into memory
+     * and read in place so the only copy made is the stripped contents. Anything that can not be
+     * mapped, such as a pipe, is read as a stream instead.
+     * @param fileName
+     *          The name of the file to read.
+     * @return
+     *          0 if file read successfully otherwise -1.
+     */
+    int readFile(string fileName);
 
     /**
      * Removes whitesapce and comments from the contents of the file.
@@ -193,6 +250,26 @@ private:
      */
     void setFile(int argc, char *argv[]);
 
+    /**
+     * Set the stats file if -stats was given.
+     * @param argc
+     *          The number of arguments.
+     * @param argv
+     *          The array of arguments.
+     */
+    void setStats(int argc, char *argv[]);
+
+    /**
+     * Set the hardware counter value if -perf was given. The counters are written to the stats file,
+     * so -stats must be given as well.
+     * @param argc
+     *          The number of arguments.
+     * @param argv
+     *          The array of arguments.
+     * @throws InvalidArgumentException
+     */
+    void setPerf(int argc, char *argv[]);
+
     /**
      * Set the help value if -h was given.
      * @param argc
@@ -231,6 +308,17 @@ private:
      */
     void setGenerations(int argc, char *argv[]);
 
+    /**
+     * Set the number of generations per tile if -block was given.
+     * @param argc
+     *          The number of arguments.
+     * @param argv
+     *          The array of arguments.
+     * @throws InvalidArgumentException
+     *          If value of the generations per tile is less than 1.
+     */
+    void setBlockDepth(int argc, char *argv[]);
+
     /**
      * Sets the grid size if -s was given.
      * @param argc
@@ -269,13 +357,13 @@ private:
     int flagPos(int argc, char *argv[], const char *flag);
 
     /**
-     * Removes whitespace from the left of a string.
-     * @param str
-     *          The string to remove the whitesapce.
-     * @return
-     *          A string with the whitespace on the left removed.
+     * Removes whitespace and comments from one line of the file and adds the rest to the input.
+     * @param line
+     *          The start of the line.
+     * @param length
+     *          The length of the line, not counting the newline.
      */
-    string trimLeft(string str);
+    void stripLine(const char *line, size_t length);
 };
 
 #endif
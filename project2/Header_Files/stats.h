@@ -0,0 +1,205 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include "perfcounters.h"
+
+using namespace std;
+
+/**
+ * Class that records where the time goes in a run: the wall time of each phase, and the wall time,
+ * number of changed cells and population of each generation. Hardware counters can also be recorded
+ * for generations and phases that start them. The stats can be written to a file in CSV or JSON format.
+ * @author Alex Cole
+ */
+class Stats
+{
+public:
+    /**
+     * The clock used to time phases and generations.
+     */
+    typedef chrono::steady_clock Clock;
+
+private:
+    /**
+     * A named phase of a run and how long it took.
+     */
+    struct Phase
+    {
+        string name;
+        double seconds;
+        bool hasCounters;
+        PerfSample counters;
+    };
+
+    /**
+     * A simulated generation, how long it took and what it changed.
+     */
+    struct Generation
+    {
+        int generation;
+        double seconds;
+        int changedCells;
+        int population;
+        bool hasCounters;
+        PerfSample counters;
+    };
+
+    /**
+     * The phases in the order they were recorded.
+     */
+    vector<Phase> phases;
+
+    /**
+     * The generations in the order they were simulated.
+     */
+    vector<Generation> generations;
+
+    /**
+     * The hardware counters. NULL if counters are not enabled.
+     */
+    PerfCounters *counters;
+
+    /**
+     * True if the counters were started and have not been recorded yet.
+     */
+    bool counting;
+
+public:
+    /**
+     * Default constructor that starts with no phases or generations.
+     */
+    Stats();
+
+    /**
+     * Destructor that closes the counters if they were enabled.
+     */
+    ~Stats();
+
+    /**
+     * Opens the hardware counters so they can be started with startCounters.
+     * @return
+     *          True if the counters are available otherwise false, in which case no counters are recorded.
+     */
+    bool enableCounters();
+
+    /**
+     * Starts the hardware counters if they are enabled. The counters are stopped and recorded with the
+     * next phase or generation that is added.
+     */
+    void startCounters();
+
+    /**
+     * Gets the current time to be passed to addPhase or addGeneration later.
+     * @return
+     *          The current time.
+     */
+    static Clock::time_point now();
+
+    /**
+     * Records a phase that started at the given time and ended now.
+     * @param name
+     *          The name of the phase.
+     * @param start
+     *          The time the phase started.
+     */
+    void addPhase(string name, Clock::time_point start);
+
+    /**
+     * Records a generation that started at the given time and ended now.
+     * @param generation
+     *          The number of the generation that was reached.
+     * @param start
+     *          The time the generation started.
+     * @param changedCells
+     *          The number of cells that changed state in the generation.
+     * @param population
+     *          The number of cells not in the default state after the generation.
+     */
+    void addGeneration(int generation, Clock::time_point start, int changedCells, int population);
+
+    /**
+     * Writes the stats to a file. The stats are written as JSON if the file name ends in .json
+     * otherwise they are written as CSV.
+     * @param file
+     *          The name of the file to write to.
+     * @return
+     *          0 if the file was written successfully otherwise -1.
+     */
+    int write(string file);
+
+private:
+    /**
+     * Copy constructor that is not allowed, since the counters cannot be shared.
+     * @param stats
+     *          The stats to copy.
+     */
+    Stats(const Stats &stats);
+
+    /**
+     * Assignment operator that is not allowed, since the counters cannot be shared.
+     * @param stats
+     *          The stats to copy.
+     * @return
+     *          This object.
+     */
+    Stats& operator=(const Stats &stats);
+
+    /**
+     * Stops the counters if they were started.
+     * @param sample
+     *          The sample the counters are read into.
+     * @return
+     *          True if the counters were read otherwise false.
+     */
+    bool stopCounters(PerfSample &sample);
+
+    /**
+     * Writes the counters of a phase or generation as CSV columns, which are empty if there are no counters.
+     * @param out
+     *          The stream to write to.
+     * @param hasCounters
+     *          True if there are counters.
+     * @param sample
+     *          The counters.
+     */
+    void writeCSVCounters(ostream &out, bool hasCounters, PerfSample &sample);
+
+    /**
+     * Writes the counters of a phase or generation as JSON members, which are left out if there are no counters.
+     * @param out
+     *          The stream to write to.
+     * @param hasCounters
+     *          True if there are counters.
+     * @param sample
+     *          The counters.
+     */
+    void writeJSONCounters(ostream &out, bool hasCounters, PerfSample &sample);
+
+    /**
+     * Writes the stats in CSV format.
+     * @param out
+     *          The stream to write to.
+     */
+    void writeCSV(ostream &out);
+
+    /**
+     * Writes the stats in JSON format.
+     * @param out
+     *          The stream to write to.
+     */
+    void writeJSON(ostream &out);
+
+    /**
+     * Gets the number of seconds from the given time until now.
+     * @param start
+     *          The time to measure from.
+     * @return
+     *          The number of seconds that have passed.
+     */
+    static double secondsSince(Clock::time_point start);
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+/**
+ * Class that runs tasks on a fixed number of threads. Tasks are run in the order they are added.
+ * @author Alex Cole
+ */
+class ThreadPool
+{
+private:
+    /**
+     * The threads that run the tasks.
+     */
+    vector<thread> workers;
+
+    /**
+     * The tasks that have not been started yet.
+     */
+    queue<function<void()>> tasks;
+
+    /**
+     * Guards the tasks, the number of running tasks and the stopping flag.
+     */
+    mutex lock;
+
+    /**
+     * Signaled when a task is added or the pool is stopping.
+     */
+    condition_variable taskAdded;
+
+    /**
+     * Signaled when a task finishes.
+     */
+    condition_variable taskFinished;
+
+    /**
+     * The number of tasks that are running.
+     */
+    int running;
+
+    /**
+     * True once the pool is being destroyed.
+     */
+    bool stopping;
+
+public:
+    /**
+     * Constructor that starts the threads.
+     * @param numThreads
+     *          The number of threads. If less than 1, the number of hardware threads is used.
+     */
+    ThreadPool(int numThreads);
+
+    /**
+     * Destructor that finishes the tasks that were added and then stops the threads.
+     */
+    ~ThreadPool();
+
+    /**
+     * Adds a task to be run by one of the threads.
+     * @param task
+     *          The task to run.
+     */
+    void add(function<void()> task);
+
+    /**
+     * Waits until all the tasks that were added have finished.
+     */
+    void wait();
+
+    /**
+     * Gets the number of threads in the pool.
+     * @return
+     *          The number of threads.
+     */
+    int size();
+
+private:
+    /**
+     * Copy constructor that is not allowed, since threads cannot be copied.
+     * @param pool
+     *          The pool to copy.
+     */
+    ThreadPool(const ThreadPool &pool);
+
+    /**
+     * Assignment operator that is not allowed, since threads cannot be copied.
+     * @param pool
+     *          The pool to copy.
+     * @return
+     *          This object.
+     */
+    ThreadPool& operator=(const ThreadPool &pool);
+
+    /**
+     * Runs tasks until the pool is stopping and there are no tasks left.
+     */
+    void work();
+};
+
+#endif
@@ -2,34 +2,174 @@
 #define WORLD_H
 
 #include "cellularautomaton.h"
+#include "stats.h"
+#include <memory>
 
 /**
- * Class that represents a world for a cellular automaton.
+ * A saved state of a world that the world can be reset to.
+ */
+struct WorldSnapshot
+{
+    /**
+     * The states of the cells in square tiles in row major order. Tiles are shared with the world
+     * and with its forks until one of them changes a cell in the tile.
+     */
+    vector<shared_ptr<vector<State>>> tiles;
+
+    /**
+     * The cells that changed in the last generation.
+     */
+    vector<Cell> changedCells;
+
+    /**
+     * The number of generations simulated.
+     */
+    int generation;
+
+    /**
+     * The number of cells that are not in the default state.
+     */
+    int population;
+
+    /**
+     * Hash of the states of the cells.
+     */
+    unsigned long long stateHash;
+};
+
+/**
+ * Class that represents a world for a cellular automaton. Copies of a world are forks that share the
+ * states of the cells in square tiles, so a world can be branched into many variants, such as one with
+ * a cell toggled or one with a different rule, without copying its grid. A fork only copies a tile
+ * when a cell in it is changed and only loads a tile into its own grid when the grid is needed.
  * @author Alex Cole
  */
 class World
 {
 private:
+    /**
+     * How the grid and a shared tile compare. SHARED if they hold the same states, CHANGED if the grid
+     * has changed since the tile was made and STALE if the grid has not been loaded from the tile.
+     */
+    enum class TileStatus {SHARED, CHANGED, STALE};
+
+    /**
+     * The size of a table indexed by state.
+     */
+    static const int StateCount = (int) State::ONE + 1;
+
+    /**
+     * The number of rows and columns of cells in a shared tile.
+     */
+    static const int SharedTileSize = 64;
+
     /**
      * The cellular automaton for this world.
      */
     CellularAutomaton *automaton;
 
     /**
-     * The grid of cells for the current state of the world.
+     * The copy of the automaton a fork makes the first time it updates the automaton, which is deleted
+     * once no fork uses it. NULL if the world has not made a copy.
+     */
+    shared_ptr<CellularAutomaton> forkAutomaton;
+
+    /**
+     * True if the automaton may be used by the world this world was forked from, so it is copied
+     * before its initial cells are updated.
+     */
+    bool automatonShared;
+
+    /**
+     * The grid of cells for the current state of the world with a border of ghost cells around it,
+     * so cell (row, col) is at [row + 1][col + 1] and each ghost cell is a copy of the cell it wraps to.
+     * Only the tiles that are not stale are up to date, and a fork has no grid until it needs one.
      */
     vector<vector<Cell>> currentWorld;
 
+    /**
+     * The states of the cells in tiles that snapshots and forks share with this world. The tiles of
+     * the grid that have changed are only made again when the tiles are shared.
+     */
+    mutable vector<shared_ptr<vector<State>>> sharedTiles;
+
+    /**
+     * How each tile of the grid compares to its shared tile.
+     */
+    mutable vector<TileStatus> tileStatus;
+
+    /**
+     * True if a tile of the grid is stale.
+     */
+    bool gridStale;
+
+    /**
+     * The number of rows of shared tiles.
+     */
+    int sharedTileRows;
+
+    /**
+     * The number of columns of shared tiles.
+     */
+    int sharedTileColumns;
+
     /**
      * The initial cells passed in by the automaton.
      */
     vector<Cell> initialCells;
 
+    /**
+     * The world at generation 0, which reset copies back.
+     */
+    WorldSnapshot initialSnapshot;
+
     /**
      * The cells that have be changed states between generations.
      */
     vector<Cell> changedCells;
 
+    /**
+     * The cells that have changed so far in a generation that is only partially simulated.
+     */
+    vector<Cell> sliceCells;
+
+    /**
+     * The next row to be simulated in a partially simulated generation. 0 if no generation is in progress.
+     */
+    int sliceRow;
+
+    /**
+     * The number of generations simulated since the world was created or reset.
+     */
+    int generation;
+
+    /**
+     * The number of cells in the grid that are not in the default state.
+     */
+    int population;
+
+    /**
+     * Hash of the states of the cells in the grid, which is kept up to date as cells change.
+     */
+    unsigned long long stateHash;
+
+    /**
+     * True if the initial cells of the automaton are the cells of the current world. They are only
+     * converted when the automaton is asked for, since only printing it in file format needs them.
+     */
+    bool automatonCurrent;
+
+    /**
+     * The stats that generations are recorded to. NULL if stats are not being recorded.
+     */
+    Stats *stats;
+
+    /**
+     * The number of generations each tile of the grid is simulated for at a time. 1 if the whole grid
+     * is simulated one generation at a time.
+     */
+    int blockDepth;
+
     /**
      * The number of rows in the grid.
      */
@@ -54,21 +194,35 @@ public:
     World(CellularAutomaton *automaton);
 
     /**
-     * Destructor that does not delete the automaton because
-     * a copy of the automaton should not be made by world or
-     * passed into world.
+     * Destructor that does not delete the automaton passed into world.
+     * A copy made by a fork is deleted once no fork uses it.
      */
     ~World();
 
     /**
-     * Copy constructor.
+     * Copy constructor that forks the world, sharing its tiles and its automaton. The fork copies the
+     * automaton before updating it with its cells, so getting the automaton of one fork does not change
+     * the automaton of the world or of any other fork.
      * @param world
      *          The world object that is to be copied.
      */
     World(const World &world);
 
     /**
-     * Overloaded assignment operator.
+     * Constructor that forks the world with a different automaton, so the same cells can be simulated
+     * with a different rule.
+     * @param world
+     *          The world object that is to be copied.
+     * @param automaton
+     *          The automaton for the fork, which must have a terrain of the same size.
+     * @throws InvalidRangeException
+     *          If the terrain of the automaton is not the same size as the world.
+     */
+    World(const World &world, CellularAutomaton *automaton);
+
+    /**
+     * Overloaded assignment operator that forks the world, sharing its tiles and its automaton until
+     * the fork updates it. Tiles of the grid that already match the tiles of the world are not loaded again.
      * @param world
      *          The world object that is to be copied.
      * @return
@@ -84,18 +238,83 @@ public:
     void simulate(int numGenerations);
 
     /**
-     * Gets the world grid based on the terrain specified in the automaton.
+     * Sets how many generations simulate advances each cache sized tile of the grid at a time. A tile is
+     * copied with a halo of depth cells around it, simulated depth generations and only its interior is
+     * written back, so a large grid is read from memory once every depth generations instead of every
+     * generation. The world ends up exactly as it would one generation at a time. Generations are still
+     * simulated one at a time while stats are being recorded.
+     * @param depth
+     *          The number of generations per tile, 1 or less to simulate one generation at a time.
+     *          Depths too deep for a tile to fit in the cache are reduced.
+     */
+    void setBlockDepth(int depth);
+
+    /**
+     * Simulates one generation without updating the automaton, which is useful when the world is
+     * only looked at through its population and hash.
      * @return
-     *          A vector of cell vectors that represents the grid of the world.
+     *          True if any cell changed state otherwise false, in which case the world will not change again.
      */
-    vector<vector<Cell>> getWorld();
+    bool step();
+
+    /**
+     * Simulates at most the given number of rows of the current generation so a long simulation can
+     * be spread out over several calls. The generation is only applied to the world once all of its
+     * rows have been simulated.
+     * @param maxRows
+     *          The maximum number of rows to simulate before returning.
+     * @return
+     *          True if the generation has been completed otherwise false.
+     */
+    bool simulateRows(int maxRows);
+
+    /**
+     * Discards a partially simulated generation, leaving the world at the last completed generation.
+     */
+    void cancelRows();
+
+    /**
+     * Updates the automaton with the cells of the current world so that it can be printed.
+     */
+    void updateAutomaton();
+
+    /**
+     * Sets the stats that each simulated generation and the conversion of the world back to terrain
+     * cells are recorded to. The stats are not deleted by the world.
+     * @param stats
+     *          The stats to record to or NULL to stop recording.
+     */
+    void setStats(Stats *stats);
 
     /**
-     * Creates a world grid based on the window specified in the automaton.
+     * Gets the number of cells that are not in the default state.
      * @return
-     *          A vector of cell vectors that represents the window view of the world.
+     *          The population of the world.
      */
-    vector<vector<Cell>> generateWindowWorld();
+    int getPopulation();
+
+    /**
+     * Gets the number of generations simulated since the world was created or reset, which is less
+     * than were asked for if the simulation stopped once the world stopped changing.
+     * @return
+     *          The generation of the world.
+     */
+    int getGeneration();
+
+    /**
+     * Gets a hash of the states of all the cells, so repeated states of the world can be found
+     * without comparing grids.
+     * @return
+     *          The hash of the world.
+     */
+    unsigned long long getHash();
+
+    /**
+     * Gets the world grid based on the terrain specified in the automaton.
+     * @return
+     *          A vector of cell vectors that represents the grid of the world.
+     */
+    vector<vector<Cell>> getWorld();
 
     /**
      * Gets the number of rows for the world grid.
@@ -112,7 +331,31 @@ public:
     int getCols();
 
     /**
-     * Gets the current automaton which may have been modified if simulate had been called
+     * Gets the state of a cell.
+     * @param row
+     *          The row of the cell.
+     * @param col
+     *          The column of the cell.
+     * @return
+     *          The state of the cell.
+     */
+    State getCellState(int row, int col);
+
+    /**
+     * Sets the state of a cell, copying only its tile if the tile is shared with a fork or snapshot.
+     * The cell counts as changed, so the next generation is simulated even if the world had settled.
+     * @param row
+     *          The row of the cell.
+     * @param col
+     *          The column of the cell.
+     * @param state
+     *          The state to set the cell to.
+     */
+    void setCellState(int row, int col, State state);
+
+    /**
+     * Gets the automaton, first updating its initial cells to the cells of the current world if any
+     * have changed since they were last updated. A fork updates its own copy of the automaton.
      * @return
      *          A pointer to world's automaton
      */
@@ -136,11 +379,48 @@ public:
      */
     vector<vector<Color>> toColor();
 
+    /**
+     * String representation of a view of the world through a window, which can be any window and
+     * not only the window of the automaton, so several views of the world can be shown at once. Each
+     * row is written straight from the grid in wrapped segments, and columns and rows that repeat
+     * because the window is bigger than the terrain are copied from the part already written.
+     * @param window
+     *          The window to view the world through, in terrain coordinates.
+     * @return
+     *          String representation of the window view of the world.
+     */
+    string toString(Range *window);
+
+    /**
+     * Color grid of a view of the world through a window, which can be any window and not only the
+     * window of the automaton, so several views of the world can be shown at once.
+     * @param window
+     *          The window to view the world through, in terrain coordinates.
+     * @return
+     *          A color grid of the window view of the world.
+     */
+    vector<vector<Color>> toColor(Range *window);
+
     /**
      * Resets the world back to the initial state when the world was first created.
      */
     void reset();
 
+    /**
+     * Resets the world to a snapshot, so different changes can be tried from the same state. Only
+     * the tiles of the grid that differ from the snapshot are loaded, once the grid is needed.
+     * @param snapshot
+     *          A snapshot taken from this world.
+     */
+    void reset(const WorldSnapshot &snapshot);
+
+    /**
+     * Takes a snapshot of the current state of the world, which shares the tiles of the world.
+     * @return
+     *          The snapshot, which the world can be reset to.
+     */
+    WorldSnapshot getSnapshot();
+
 private:
     /**
      * Converts the initial terrain cell positions to grid friendly positions.
@@ -153,47 +433,180 @@ private:
     void updateWorld();
 
     /**
-     * Creates a string version of the window view of the world.
+     * Copies the cells on each edge of the grid to the ghost cells past the opposite edge, so the
+     * neighbors of every cell are in the grid and wrap around the terrain.
+     */
+    void updateGhostCells();
+
+    /**
+     * Adds the change of a cell state to the population and hash of the world.
+     * @param row
+     *          The row of the cell.
+     * @param col
+     *          The column of the cell.
+     * @param oldState
+     *          The state the cell was in.
+     * @param state
+     *          The state the cell is in now.
+     */
+    void countCellChange(int row, int col, State oldState, State state);
+
+    /**
+     * Gets the index of the shared tile a cell is in.
+     * @param row
+     *          The row of the cell.
+     * @param col
+     *          The column of the cell.
+     * @return
+     *          The index of the tile.
+     */
+    int sharedTileIndex(int row, int col);
+
+    /**
+     * Makes the shared tiles of the grid tiles that have changed again, so the shared tiles hold the
+     * current world. A tile that is not shared is reused.
+     */
+    void shareTiles() const;
+
+    /**
+     * Switches the world to the given tiles, marking every tile of the grid stale unless it already
+     * holds the same states as the tile.
+     * @param tiles
+     *          The tiles of a world of the same size.
+     */
+    void useTiles(const vector<shared_ptr<vector<State>>> &tiles);
+
+    /**
+     * Loads the stale tiles of the grid from their shared tiles, creating the grid if the world does
+     * not have one yet.
+     */
+    void loadGrid();
+
+    /**
+     * Gets the hash of one cell in the given state, which is added to the world hash while the cell
+     * is in that state.
+     * @param row
+     *          The row of the cell.
+     * @param col
+     *          The column of the cell.
+     * @param state
+     *          The state of the cell.
      * @return
-     *          The string representation of the window view of the world.
+     *          The hash of the cell.
      */
-    string toStringWindow();
+    unsigned long long cellHash(int row, int col, State state);
 
     /**
-     * Creates a color grid based on the window view of the world.
+     * Simulates the given number of generations a block of generations at a time by simulating each
+     * tile of the grid for the whole block, stopping early if a generation changes no cells.
+     * @param numGenerations
+     *          The number of generations to simulate.
+     */
+    void simulateBlocks(int numGenerations);
+
+    /**
+     * Copies a tile of the grid and a halo around it and simulates it for a block of generations. Cells
+     * within n cells of the edge of the halo depend on cells outside of it after n generations, so each
+     * generation is simulated on a smaller area until only the tile is left.
+     * @param rowStart
+     *          The first row of the tile.
+     * @param colStart
+     *          The first column of the tile.
+     * @param tileRows
+     *          The number of rows in the tile.
+     * @param tileCols
+     *          The number of columns in the tile.
+     * @param depth
+     *          The number of generations to simulate, which is also the width of the halo.
+     * @param tiles
+     *          Two grids big enough for the tile and its halo that generations are simulated between.
+     * @param blockCells
+     *          The cell vector the tile cells that differ from the grid after the block are added to.
+     * @param lastCells
+     *          The cell vector the tile cells that changed in the last generation of the block are added to.
      * @return
-     *          A vector of color vectors that represent the window view of the world.
+     *          The last generation of the block that changed a cell of the tile, 0 if none did.
      */
-    vector<vector<Color>> toColorWindow();
+    int simulateTile(int rowStart, int colStart, int tileRows, int tileCols, int depth, vector<vector<Cell>> tiles[],
+        vector<Cell> &blockCells, vector<Cell> &lastCells);
 
     /**
-     * Creates a world with the given rows and columns and sets all states to default.
-     * @param rows
-     *          The number of rows.
-     * @param columns
-     *          The number of columns.
+     * Finds the size of a tile such that two grids of a tile and its halo fit in the L2 cache, reducing
+     * the depth if it is too deep for a useful tile to fit.
+     * @param depth
+     *          The number of generations per tile, which is reduced if it is too deep.
      * @return
-     *          The world as a vector of cell vectors with all cells set to default
+     *          The number of rows and columns in a tile.
      */
-    vector<vector<Cell>> createWorld(int rows, int columns);
+    static int blockTileSize(int &depth);
 
     /**
-     * Converts a given world to a string representation of the world.
-     * @param world
-     *          The world to convert into a string.
+     * Finds the cells in the given rows that will change state in the next generation.
+     * @param rowStart
+     *          The first row to check.
+     * @param rowEnd
+     *          The row after the last row to check.
+     * @param cells
+     *          The cell vector the changed cells are added to.
+     */
+    void findChangedCells(int rowStart, int rowEnd, vector<Cell> &cells);
+
+    /**
+     * Finds the size of a window and the row and column of the grid its top left corner is at.
+     * @param window
+     *          The window in terrain coordinates.
+     * @param topRow
+     *          Set to the row of the grid the window starts at.
+     * @param leftCol
+     *          Set to the column of the grid the window starts at.
+     * @param winRows
+     *          Set to the number of rows in the window.
+     * @param winCols
+     *          Set to the number of columns in the window.
+     */
+    void windowPosition(Range *window, int &topRow, int &leftCol, int &winRows, int &winCols);
+
+    /**
+     * Gets the row of the grid shown in a row of a window. The rows from the top row down are shown in
+     * order, wrapping around to the first row of the terrain, except that a window starting at the last
+     * row shows it twice before wrapping.
+     * @param winRow
+     *          The row of the window.
+     * @param topRow
+     *          The row of the grid the window starts at.
      * @return
-     *          A string representation of given world.
+     *          The row of the grid.
      */
-    string toStringWorld(vector<vector<Cell>> world);
+    int windowRow(int winRow, int topRow);
 
     /**
-     * Converts a given world to a color representation of the world.
-     * @param world
-     *          The world to convert into a color world.
+     * Writes a row of a window from a row of the grid, looking up the value of each state in a table.
+     * The row is read in at most two segments that wrap around the terrain, and the rest of a window
+     * wider than the terrain is copied from the columns already written.
+     * @param out
+     *          Where the row of the window is written.
+     * @param table
+     *          The value written for each state.
+     * @param row
+     *          The row of the grid.
+     * @param leftCol
+     *          The column of the grid the window starts at.
+     * @param winCols
+     *          The number of columns in the window.
+     */
+    template<class T>
+    void renderRow(T *out, const T table[], int row, int leftCol, int winCols);
+
+    /**
+     * Creates a world with the given rows and columns and sets all states to default.
+     * @param rows
+     *          The number of rows.
+     * @param columns
+     *          The number of columns.
      * @return
-     *          A vector of color vectors that represents a color version of the world.
+     *          The world as a vector of cell vectors with all cells set to default
      */
-    vector<vector<Color>> toColorWorld(vector<vector<Cell>> world);
+    vector<vector<Cell>> createWorld(int rows, int columns);
 
     /**
      * Sets position to start in the terrain.
@@ -206,17 +619,6 @@ private:
      */
     int setStartPos(int diff, int length);
 
-    /**
-     * Fills the window world with values from the terrain based on terrain starting positions.
-     * @param windowWorld
-     *          The window view of the world.
-     * @param rowStart
-     *          The row to start at in the terrain.
-     * @param colStart
-     *          The column to start at in the terrain.
-     */
-    void fillWindowWorld(vector<vector<Cell>> &windowWorld, int rowStart, int colStart);
-
     /**
      * Gets the cells in the world that are not in the default state.
      * @return
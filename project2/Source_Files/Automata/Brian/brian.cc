@@ -3,6 +3,7 @@
 #include "briancolors.h"
 #include "brianinitial.h"
 #include "automatonparser.h"
+#include "automatonsteps.h"
 #include <sstream>
 
 /**
@@ -28,9 +29,10 @@ Brian::Brian(string brianStruct)
     : CellularAutomaton(brianStruct)
 {
     map<string, string> brian = AutomatonParser::parse(brianStruct);
+    string().swap(brianStruct);
     setChars(new BrianChars(AutomatonParser::getValue(brian, "Chars", true)));
     setColors(new BrianColors(AutomatonParser::getValue(brian, "Colors", true)));
-    setInitial(new BrianInitial(AutomatonParser::getValue(brian, "Initial", true), getTerrain()));
+    setInitial(new BrianInitial(AutomatonParser::takeValue(brian, "Initial", true), getTerrain()));
 }
 
 /**
@@ -39,12 +41,7 @@ Brian::Brian(string brianStruct)
  *              The brian automaton to be copied.
  */
 Brian::Brian(const Brian &brian)
-    : CellularAutomaton(brian)
-{
-    setChars(brian.getChars() != NULL ? new BrianChars(*((BrianChars*) brian.getChars())) : NULL);
-    setColors(brian.getColors() != NULL ? new BrianColors(*((BrianColors*) brian.getColors())) : NULL);
-    setInitial(brian.getInitial() != NULL ? new BrianInitial(*((BrianInitial*) brian.getInitial())) : NULL);
-}
+    : CellularAutomaton(brian) {}
 
 /**
  * Destructor
@@ -62,9 +59,6 @@ Brian& Brian::operator=(const Brian &brian)
 {
     if(this == &brian) return *this;
     CellularAutomaton::operator=(brian);
-    setChars(brian.getChars() != NULL ? new BrianChars(*((BrianChars*) brian.getChars())) : NULL);
-    setColors(brian.getColors() != NULL ? new BrianColors(*((BrianColors*) brian.getColors())) : NULL);
-    setInitial(brian.getInitial() != NULL ? new BrianInitial(*((BrianInitial*) brian.getInitial())) : NULL);
     return *this;
 }
 
@@ -84,31 +78,59 @@ State Brian::nextCellState(vector<vector<Cell>> &world, Cell &cell)
     if(state == State::FIRING) return State::DEFAULT;
     if(state == State::DEFAULT) return State::READY;
 
-    int count = 0;
     int row = cell.getX();
     int col = cell.getY();
-    int rows = world.size();
-    int columns = world[0].size();
-
-    int minusRow = (row - 1) < 0 ? rows - 1 : row -1; //wrap around values
-    int plusRow = (row + 1) >= rows ? 0 : row + 1;
-    int minusCol = (col - 1) < 0 ? columns -1 : col - 1;
-    int plusCol = (col + 1) >= columns ? 0 : col + 1;
-
-    if(world[minusRow][col].getState() == State::FIRING) count++; //checks each of the 8 neighbors
-    if(world[row][minusCol].getState() == State::FIRING) count++;
-    if(world[plusRow][col].getState() == State::FIRING) count++;
-    if(world[row][plusCol].getState() == State::FIRING) count++;
-    if(world[plusRow][minusCol].getState() == State::FIRING) count++;
-    if(world[plusRow][plusCol].getState() == State::FIRING) count++;
-    if(world[minusRow][minusCol].getState() == State::FIRING) count++;
-    if(world[minusRow][plusCol].getState() == State::FIRING) count++;
+    vector<Cell> &above = world[row - 1]; //the ghost border means neighbors never need to wrap
+    vector<Cell> &current = world[row];
+    vector<Cell> &below = world[row + 1];
+
+    int count = (above[col - 1].getState() == State::FIRING) + (above[col].getState() == State::FIRING) //checks each of the 8 neighbors
+        + (above[col + 1].getState() == State::FIRING) + (current[col - 1].getState() == State::FIRING)
+        + (current[col + 1].getState() == State::FIRING) + (below[col - 1].getState() == State::FIRING)
+        + (below[col].getState() == State::FIRING) + (below[col + 1].getState() == State::FIRING);
 
     if(count == 2) return State::FIRING;
 
     return State::READY;
 }
 
+/**
+ * Finds the cells in the given rows that will change state in the next generation.
+ * @param world
+ *              The grid of cells with a border of ghost cells around it.
+ * @param rowStart
+ *              The first row to check, not counting the ghost border.
+ * @param rowEnd
+ *              The row after the last row to check, not counting the ghost border.
+ * @param cells
+ *              The cell vector the changed cells are added to, with their positions not counting
+ *              the ghost border.
+ */
+void Brian::findChangedCells(vector<vector<Cell>> &world, int rowStart, int rowEnd, vector<Cell> &cells)
+{
+    findChangedCellsWith(*this, world, rowStart, rowEnd, cells);
+}
+
+/**
+ * Sets the next state of each cell in a region of a grid in another grid of the same size.
+ * @param world
+ *              The grid of cells. Every neighbor of the region must be in the grid.
+ * @param next
+ *              The grid the next states are set in.
+ * @param rowStart
+ *              The first row of the region.
+ * @param rowEnd
+ *              The row after the last row of the region.
+ * @param colStart
+ *              The first column of the region.
+ * @param colEnd
+ *              The column after the last column of the region.
+ */
+void Brian::nextStates(vector<vector<Cell>> &world, vector<vector<Cell>> &next, int rowStart, int rowEnd, int colStart, int colEnd)
+{
+    nextStatesWith(*this, world, next, rowStart, rowEnd, colStart, colEnd);
+}
+
 /**
  * Gets the char representation of the state of the given cell.
  * @param cell
@@ -178,3 +200,13 @@ string Brian::toString()
     ret << getChars()->toString() << "\n\n\t" << getColors()->toString() << "\n\n\t" << getInitial()->toString() << "\n};";
     return ret.str();
 }
+
+/**
+ * Creates a copy of the automaton with the same type.
+ * @return
+ *              The copy, which must be deleted by the caller.
+ */
+CellularAutomaton* Brian::clone() const
+{
+    return new Brian(*this);
+}
@@ -34,6 +34,7 @@ BrianInitial::BrianInitial(vector<Cell> cells)
 BrianInitial::BrianInitial(string brianInitialStruct, Range *terrain)
 {
     map<string, string> initial  = AutomatonParser::parse(brianInitialStruct);
+    string().swap(brianInitialStruct);
     convertCellStr(AutomatonParser::getValue(initial, "Ready"), terrain, State::READY);
     convertCellStr(AutomatonParser::getValue(initial, "Firing"), terrain, State::FIRING);
 }
@@ -111,3 +112,13 @@ string BrianInitial::toString()
     ret << "\t};";
     return ret.str();
 }
+
+/**
+ * Creates a copy of the brian initial.
+ * @return
+ *              The copy, which must be deleted by the caller.
+ */
+Initial* BrianInitial::clone() const
+{
+    return new BrianInitial(*this);
+}
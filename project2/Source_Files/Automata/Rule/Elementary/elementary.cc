@@ -3,6 +3,7 @@
 #include "elementarycolors.h"
 #include "elementaryinitial.h"
 #include "automatonparser.h"
+#include "automatonsteps.h"
 #include <sstream>
 #include <iostream>
 
@@ -31,14 +32,15 @@ Elementary::Elementary(string elementaryStruct)
     : RuleAutomaton(elementaryStruct)
 {
     map<string, string> elementary = AutomatonParser::parse(elementaryStruct);
+    string().swap(elementaryStruct);
     if(!validRule())
     {
-        cerr << "Invalid rule: " << getRule() << endl;
+        AutomatonParser::errors() << "Invalid rule: " << getRule() << endl;
         throw InvalidRuleException;
     }
     setChars(new ElementaryChars(AutomatonParser::getValue(elementary, "Chars", true)));
     setColors(new ElementaryColors(AutomatonParser::getValue(elementary, "Colors", true)));
-    setInitial(new ElementaryInitial(AutomatonParser::getValue(elementary, "Initial",true), getTerrain()));
+    setInitial(new ElementaryInitial(AutomatonParser::takeValue(elementary, "Initial", true), getTerrain()));
 }
 
 /**
@@ -47,12 +49,7 @@ Elementary::Elementary(string elementaryStruct)
  *                  The elementary automaton to be copied.
  */
 Elementary::Elementary(const Elementary &elementary)
-    : RuleAutomaton(elementary)
-{
-    setChars(elementary.getChars() != NULL ? new ElementaryChars(*((ElementaryChars*) elementary.getChars())) : NULL);
-    setColors(elementary.getColors() != NULL ? new ElementaryColors(*((ElementaryColors*) elementary.getColors())) : NULL);
-    setInitial(elementary.getInitial() != NULL ? new ElementaryInitial(*((ElementaryInitial*) elementary.getInitial())) : NULL);
-}
+    : RuleAutomaton(elementary) {}
 
 /**
  * Destructor
@@ -70,9 +67,6 @@ Elementary& Elementary::operator=(const Elementary &elementary)
 {
     if(this == &elementary) return *this;
     RuleAutomaton::operator=(elementary);
-    setChars(elementary.getChars() != NULL ? new ElementaryChars(*((ElementaryChars*) elementary.getChars())) : NULL);
-    setColors(elementary.getColors() != NULL ? new ElementaryColors(*((ElementaryColors*) elementary.getColors())) : NULL);
-    setInitial(elementary.getInitial() != NULL ? new ElementaryInitial(*((ElementaryInitial*) elementary.getInitial())) : NULL);
     return *this;
 }
 
@@ -101,6 +95,43 @@ State Elementary::nextCellState(vector<vector<Cell>> &world, Cell &cell)
     return State::DEFAULT;
 }
 
+/**
+ * Finds the cells in the given rows that will change state in the next generation.
+ * @param world
+ *              The grid of cells with a border of ghost cells around it.
+ * @param rowStart
+ *              The first row to check, not counting the ghost border.
+ * @param rowEnd
+ *              The row after the last row to check, not counting the ghost border.
+ * @param cells
+ *              The cell vector the changed cells are added to, with their positions not counting
+ *              the ghost border.
+ */
+void Elementary::findChangedCells(vector<vector<Cell>> &world, int rowStart, int rowEnd, vector<Cell> &cells)
+{
+    findChangedCellsWith(*this, world, rowStart, rowEnd, cells);
+}
+
+/**
+ * Sets the next state of each cell in a region of a grid in another grid of the same size.
+ * @param world
+ *              The grid of cells. Every neighbor of the region must be in the grid.
+ * @param next
+ *              The grid the next states are set in.
+ * @param rowStart
+ *              The first row of the region.
+ * @param rowEnd
+ *              The row after the last row of the region.
+ * @param colStart
+ *              The first column of the region.
+ * @param colEnd
+ *              The column after the last column of the region.
+ */
+void Elementary::nextStates(vector<vector<Cell>> &world, vector<vector<Cell>> &next, int rowStart, int rowEnd, int colStart, int colEnd)
+{
+    nextStatesWith(*this, world, next, rowStart, rowEnd, colStart, colEnd);
+}
+
 /**
  * Gets the char representation of the state of the given cell.
  * @param cell
@@ -165,6 +196,16 @@ string Elementary::toString()
     return ret.str();
 }
 
+/**
+ * Creates a copy of the automaton with the same type.
+ * @return
+ *              The copy, which must be deleted by the caller.
+ */
+CellularAutomaton* Elementary::clone() const
+{
+    return new Elementary(*this);
+}
+
 /**
  * Gets the bit value in an unsigned char at the given position.
  * @param ch
@@ -181,7 +222,7 @@ int Elementary::getBit(unsigned char ch, int pos)
 
 /**
  * Creates a string rule pattern based on the state of the 3 cells
- * above the given cell (accounts for wrap around).
+ * above the given cell (wrap around comes from the ghost cells).
  * @param world
  *              The grid of cells to compare the cell to its neighbors.
  * @param cell
@@ -193,17 +234,12 @@ string Elementary::rulePattern(vector<vector<Cell>> &world, Cell &cell)
 {
     int row = cell.getX();
     int col = cell.getY();
-    int rows = world.size();
-    int columns = world[0].size();
-
-    int minusRow = (row - 1) < 0 ? rows - 1 : row - 1; //wrap around values
-    int minusCol = (col - 1) < 0 ? columns -1 : col - 1;
-    int plusCol = (col + 1) >= columns ? 0 : col + 1;
+    vector<Cell> &above = world[row - 1]; //the ghost border means neighbors never need to wrap
 
-    string pattern; //checks the state of the cells above the given cell (accounting for wrap around)
-    pattern = world[minusRow][minusCol].getState() == State::ONE ? pattern + "1" : pattern + "0";
-    pattern = world[minusRow][col].getState() == State::ONE ? pattern + "1" : pattern + "0";
-    pattern = world[minusRow][plusCol].getState() == State::ONE ? pattern + "1" : pattern + "0";
+    string pattern; //checks the state of the cells above the given cell
+    pattern = above[col - 1].getState() == State::ONE ? pattern + "1" : pattern + "0";
+    pattern = above[col].getState() == State::ONE ? pattern + "1" : pattern + "0";
+    pattern = above[col + 1].getState() == State::ONE ? pattern + "1" : pattern + "0";
     return pattern;
 }
 
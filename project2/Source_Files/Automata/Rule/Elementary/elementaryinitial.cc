@@ -34,6 +34,7 @@ ElementaryInitial::ElementaryInitial(vector<Cell> cells)
 ElementaryInitial::ElementaryInitial(string elementaryInitialStruct, Range *terrain)
 {
     map<string, string> initial  = AutomatonParser::parse(elementaryInitialStruct);
+    string().swap(elementaryInitialStruct);
     convertCellStr(AutomatonParser::getValue(initial, "One"), terrain, State::ONE);
 }
 
@@ -89,3 +90,13 @@ string ElementaryInitial::toString()
     ret << ";\n\t};";
     return ret.str();
 }
+
+/**
+ * Creates a copy of the elementary initial.
+ * @return
+ *              The copy, which must be deleted by the caller.
+ */
+Initial* ElementaryInitial::clone() const
+{
+    return new ElementaryInitial(*this);
+}
@@ -3,6 +3,7 @@
 #include "lifechars.h"
 #include "lifecolors.h"
 #include "automatonparser.h"
+#include "automatonsteps.h"
 #include <sstream>
 #include <iostream>
 
@@ -29,11 +30,12 @@ Life::Life(string lifeStruct)
     : RuleAutomaton(lifeStruct)
 {
     map<string, string> life = AutomatonParser::parse(lifeStruct);
+    string().swap(lifeStruct); //frees the struct since the initial cells can be most of the file
     setBorn();
     setStayAlive();
     setChars(new LifeChars(AutomatonParser::getValue(life, "Chars", true)));
     setColors(new LifeColors(AutomatonParser::getValue(life, "Colors", true)));
-    setInitial(new LifeInitial(AutomatonParser::getValue(life, "Initial", true), getTerrain()));
+    setInitial(new LifeInitial(AutomatonParser::takeValue(life, "Initial", true), getTerrain()));
 }
 
 /**
@@ -46,9 +48,6 @@ Life::Life(const Life &life)
 {
     born = life.born;
     stayAlive = life.stayAlive;
-    setChars(life.getChars() != NULL ? new LifeChars(*((LifeChars*) life.getChars())) : NULL);
-    setColors(life.getColors() != NULL ? new LifeColors(*((LifeColors*) life.getColors())) : NULL);
-    setInitial(life.getInitial() != NULL ? new LifeInitial(*((LifeInitial*) life.getInitial())) : NULL);
 }
 
 /**
@@ -69,9 +68,6 @@ Life& Life::operator=(const Life &life)
     RuleAutomaton::operator=(life);
     born = life.born;
     stayAlive = life.stayAlive;
-    setChars(life.getChars() != NULL ? new LifeChars(*((LifeChars*) life.getChars())) : NULL);
-    setColors(life.getColors() != NULL ? new LifeColors(*((LifeColors*) life.getColors())) : NULL);
-    setInitial(life.getInitial() != NULL ? new LifeInitial(*((LifeInitial*) life.getInitial())) : NULL);
     return *this;
 }
 
@@ -87,30 +83,58 @@ Life& Life::operator=(const Life &life)
  */
 State Life::nextCellState(vector<vector<Cell>> &world, Cell &cell)
 {
-    int count = 0;
     int row = cell.getX();
     int col = cell.getY();
-    int rows = world.size();
-    int columns = world[0].size();
-
-    int minusRow = (row - 1) < 0 ? rows - 1 : row -1; //wrap around values
-    int plusRow = (row + 1) >= rows ? 0 : row + 1;
-    int minusCol = (col - 1) < 0 ? columns -1 : col - 1;
-    int plusCol = (col + 1) >= columns ? 0 : col + 1;
-
-    if(world[minusRow][col].getState() == State::ALIVE) count++; //checks each of the 8 neighbors
-    if(world[row][minusCol].getState() == State::ALIVE) count++;
-    if(world[plusRow][col].getState() == State::ALIVE) count++;
-    if(world[row][plusCol].getState() == State::ALIVE) count++;
-    if(world[plusRow][minusCol].getState() == State::ALIVE) count++;
-    if(world[plusRow][plusCol].getState() == State::ALIVE) count++;
-    if(world[minusRow][minusCol].getState() == State::ALIVE) count++;
-    if(world[minusRow][plusCol].getState() == State::ALIVE) count++;
+    vector<Cell> &above = world[row - 1]; //the ghost border means neighbors never need to wrap
+    vector<Cell> &current = world[row];
+    vector<Cell> &below = world[row + 1];
+
+    int count = (above[col - 1].getState() == State::ALIVE) + (above[col].getState() == State::ALIVE) //checks each of the 8 neighbors
+        + (above[col + 1].getState() == State::ALIVE) + (current[col - 1].getState() == State::ALIVE)
+        + (current[col + 1].getState() == State::ALIVE) + (below[col - 1].getState() == State::ALIVE)
+        + (below[col].getState() == State::ALIVE) + (below[col + 1].getState() == State::ALIVE);
 
     if(isBorn(count) || (cell.getState() == State::ALIVE && staysAlive(count))) return State::ALIVE;
 
     return State::DEFAULT;
 }
+
+/**
+ * Finds the cells in the given rows that will change state in the next generation.
+ * @param world
+ *              The grid of cells with a border of ghost cells around it.
+ * @param rowStart
+ *              The first row to check, not counting the ghost border.
+ * @param rowEnd
+ *              The row after the last row to check, not counting the ghost border.
+ * @param cells
+ *              The cell vector the changed cells are added to, with their positions not counting
+ *              the ghost border.
+ */
+void Life::findChangedCells(vector<vector<Cell>> &world, int rowStart, int rowEnd, vector<Cell> &cells)
+{
+    findChangedCellsWith(*this, world, rowStart, rowEnd, cells);
+}
+
+/**
+ * Sets the next state of each cell in a region of a grid in another grid of the same size.
+ * @param world
+ *              The grid of cells. Every neighbor of the region must be in the grid.
+ * @param next
+ *              The grid the next states are set in.
+ * @param rowStart
+ *              The first row of the region.
+ * @param rowEnd
+ *              The row after the last row of the region.
+ * @param colStart
+ *              The first column of the region.
+ * @param colEnd
+ *              The column after the last column of the region.
+ */
+void Life::nextStates(vector<vector<Cell>> &world, vector<vector<Cell>> &next, int rowStart, int rowEnd, int colStart, int colEnd)
+{
+    nextStatesWith(*this, world, next, rowStart, rowEnd, colStart, colEnd);
+}
 /**
  * Gets the char representation of the state of the given cell.
  * @param cell
@@ -175,6 +199,90 @@ string Life::toString()
     return ret.str();
 }
 
+/**
+ * Creates a copy of the automaton with the same type.
+ * @return
+ *              The copy, which must be deleted by the caller.
+ */
+CellularAutomaton* Life::clone() const
+{
+    return new Life(*this);
+}
+
+/**
+ * Sets the rule with the given rule string and updates the born and stay alive counts.
+ * @param rule
+ *              The rule string in the form B012../S012..
+ * @throws InvalidRuleException
+ *              If the rule is not in valid format (B012../S012..)
+ */
+void Life::setRule(string rule)
+{
+    RuleAutomaton::setRule(rule);
+    born.clear();
+    stayAlive.clear();
+    setBorn();
+    setStayAlive();
+}
+
+/**
+ * Sets the rule from bit masks of neighbor counts, where bit n is set if n alive neighbors
+ * cause a cell to be born or stay alive. Unlike a rule read from a file, either mask may be
+ * empty, so every one of the 2^18 life-like rules can be set.
+ * @param bornMask
+ *              The neighbor counts (bits 0-8) that cause a cell to be born.
+ * @param stayAliveMask
+ *              The neighbor counts (bits 0-8) that cause a cell to stay alive.
+ */
+void Life::setRuleMasks(int bornMask, int stayAliveMask)
+{
+    string rule = "B";
+    born.clear();
+    stayAlive.clear();
+    for(int count = 0; count <= 8; count++)
+    {
+        if((bornMask >> count) & 1)
+        {
+            born.push_back(count);
+            rule += (char) ('0' + count);
+        }
+    }
+    rule += "/S";
+    for(int count = 0; count <= 8; count++)
+    {
+        if((stayAliveMask >> count) & 1)
+        {
+            stayAlive.push_back(count);
+            rule += (char) ('0' + count);
+        }
+    }
+    RuleAutomaton::setRule(rule);
+}
+
+/**
+ * Gets the neighbor counts that cause a cell to be born as a bit mask.
+ * @return
+ *              The mask where bit n is set if n alive neighbors cause a cell to be born.
+ */
+int Life::getBornMask()
+{
+    int mask = 0;
+    for(unsigned int i = 0; i < born.size(); i++) mask |= 1 << born[i];
+    return mask;
+}
+
+/**
+ * Gets the neighbor counts that cause a cell to stay alive as a bit mask.
+ * @return
+ *              The mask where bit n is set if n alive neighbors cause a cell to stay alive.
+ */
+int Life::getStayAliveMask()
+{
+    int mask = 0;
+    for(unsigned int i = 0; i < stayAlive.size(); i++) mask |= 1 << stayAlive[i];
+    return mask;
+}
+
 /**
  * Adds values to the born int vector based on the rule string.
  * @throws InvalidRuleException
@@ -185,21 +293,21 @@ void Life::setBorn()
     string ruleStr = getRule();
     if(ruleStr[0] != 'B')
     {
-        cerr << "Invalid rule: " << ruleStr << endl;
+        AutomatonParser::errors() << "Invalid rule: " << ruleStr << endl;
         throw InvalidRuleException;
     }
 
     int split = ruleStr.find("/");
     if(split == string::npos)
     {
-        cerr << "Invalid rule: " << ruleStr << endl;
+        AutomatonParser::errors() << "Invalid rule: " << ruleStr << endl;
         throw InvalidRuleException;
     }
 
     fillVectorFromDigitStr(born, ruleStr.substr(0, split));
     if(born.size() == 0)
     {
-        cerr << "Invalid rule: " << ruleStr << endl;
+        AutomatonParser::errors() << "Invalid rule: " << ruleStr << endl;
         throw InvalidRuleException;
     }
 }
@@ -215,20 +323,20 @@ void Life::setStayAlive()
     int split = ruleStr.find("/");
     if(split == string::npos)
     {
-        cerr << "Invalid rule: " << ruleStr << endl;
+        AutomatonParser::errors() << "Invalid rule: " << ruleStr << endl;
         throw InvalidRuleException;
     }
 
     if(split + 1 >= ruleStr.length() || ruleStr[split + 1] != 'S')
     {
-        cerr << "Invalid rule: " << ruleStr << endl;
+        AutomatonParser::errors() << "Invalid rule: " << ruleStr << endl;
         throw InvalidRuleException;
     }
 
     fillVectorFromDigitStr(stayAlive, ruleStr.substr(split + 1, ruleStr.length()));
     if(stayAlive.size() == 0)
     {
-        cerr << "Invalid rule: " << ruleStr << endl;
+        AutomatonParser::errors() << "Invalid rule: " << ruleStr << endl;
         throw InvalidRuleException;
     }
 }
@@ -249,7 +357,7 @@ void Life::fillVectorFromDigitStr(vector<int> &digits, string digitStr)
         int num = digitStr[i] - '0';
         if(num < 0 || num > 8)
         {
-            cerr << "Invalid rule: " << getRule() << endl;
+            AutomatonParser::errors() << "Invalid rule: " << getRule() << endl;
             throw InvalidRuleException;
         }
         digits.push_back(num);
@@ -35,6 +35,7 @@ LifeInitial::LifeInitial(vector<Cell> cells)
 LifeInitial::LifeInitial(string lifeInitialStruct, Range *terrain)
 {
     map<string, string> initial  = AutomatonParser::parse(lifeInitialStruct);
+    string().swap(lifeInitialStruct);
     convertCellStr(AutomatonParser::getValue(initial, "Alive"), terrain, State::ALIVE);
 }
 
@@ -90,3 +91,13 @@ string LifeInitial::toString()
     ret << ";\n\t};";
     return ret.str();
 }
+
+/**
+ * Creates a copy of the life-like initial.
+ * @return
+ *              The copy, which must be deleted by the caller.
+ */
+Initial* LifeInitial::clone() const
+{
+    return new LifeInitial(*this);
+}
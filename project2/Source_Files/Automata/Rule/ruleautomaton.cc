@@ -22,7 +22,7 @@ RuleAutomaton::RuleAutomaton()
  * @param ruleAutomatonStruct
  *              The string rule automaton struct.
  */
-RuleAutomaton::RuleAutomaton(string ruleAutomatonStruct)
+RuleAutomaton::RuleAutomaton(const string &ruleAutomatonStruct)
     : CellularAutomaton(ruleAutomatonStruct)
 {
     map<string, string> ruleAutomaton = AutomatonParser::parse(ruleAutomatonStruct);
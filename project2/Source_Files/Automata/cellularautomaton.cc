@@ -22,42 +22,40 @@ CellularAutomaton::CellularAutomaton()
  * @param automatonStruct
  *          The automaton struct.
  */
-CellularAutomaton::CellularAutomaton(string automatonStruct)
+CellularAutomaton::CellularAutomaton(const string &automatonStruct)
 {
     setToDefaults();
     map<string, string> automaton = AutomatonParser::parse(automatonStruct);
     name = automaton["Name"];
-    terrain = new Range(AutomatonParser::getValue(automaton, "Terrain", true));
+    terrain = make_shared<Range>(AutomatonParser::getValue(automaton, "Terrain", true));
     string windowStruct = automaton["Window"];
-    if(!windowStruct.empty()) window = new Range(windowStruct);
+    if(!windowStruct.empty()) window = make_shared<Range>(windowStruct);
 }
 
 /**
- * Destructor
+ * Destructor that deletes the terrain, window, chars, colors and initial once
+ * no copy of the automaton uses them.
  */
-CellularAutomaton::~CellularAutomaton()
-{
-    delete terrain;
-    delete window;
-    delete chars;
-    delete colors;
-    delete initial;
-}
+CellularAutomaton::~CellularAutomaton() {}
 
 /**
- * Copy constructor.
+ * Copy constructor that shares the terrain, window, chars, colors and initial of the automaton.
  * @param automaton
  *          The automaton to be copied.
  */
 CellularAutomaton::CellularAutomaton(const CellularAutomaton &automaton)
 {
     name = automaton.name;
-    terrain = automaton.terrain != NULL ? new Range(*(automaton.terrain)) : NULL;
-    window =  automaton.window != NULL ? new Range(*(automaton.window)) : NULL;
+    terrain = automaton.terrain;
+    window = automaton.window;
+    chars = automaton.chars;
+    colors = automaton.colors;
+    initial = automaton.initial;
 }
 
 /**
- * Overloaded assignment operator
+ * Overloaded assignment operator that shares the terrain, window, chars, colors and initial of
+ * the automaton.
  * @param automaton
  *          The automaton to be copied
  * @return
@@ -67,8 +65,11 @@ CellularAutomaton& CellularAutomaton::operator=(const CellularAutomaton &automat
 {
     if(this == &automaton) return *this;
     name = automaton.name;
-    terrain = automaton.terrain != NULL ? new Range(*(automaton.terrain)) : NULL;
-    window =  automaton.window != NULL ? new Range(*(automaton.window)) : NULL;
+    terrain = automaton.terrain;
+    window = automaton.window;
+    chars = automaton.chars;
+    colors = automaton.colors;
+    initial = automaton.initial;
     return *this;
 }
 
@@ -79,7 +80,7 @@ CellularAutomaton& CellularAutomaton::operator=(const CellularAutomaton &automat
  */
 Range* CellularAutomaton::getTerrain() const
 {
-    return terrain;
+    return terrain.get();
 }
 
 /**
@@ -89,7 +90,7 @@ Range* CellularAutomaton::getTerrain() const
  */
 Range* CellularAutomaton::getWindow() const
 {
-    return window;
+    return window.get();
 }
 
 /**
@@ -99,7 +100,7 @@ Range* CellularAutomaton::getWindow() const
  */
 Chars* CellularAutomaton::getChars() const
 {
-    return chars;
+    return chars.get();
 }
 
 /**
@@ -109,7 +110,7 @@ Chars* CellularAutomaton::getChars() const
  */
 Colors* CellularAutomaton::getColors() const
 {
-    return colors;
+    return colors.get();
 }
 
 /**
@@ -119,7 +120,7 @@ Colors* CellularAutomaton::getColors() const
  */
 Initial* CellularAutomaton::getInitial() const
 {
-    return initial;
+    return initial.get();
 }
 
 /**
@@ -132,19 +133,34 @@ string CellularAutomaton::getName() const
     return name;
 }
 
+/**
+ * Sets Chars to the given Chars, deleting the old Chars once no copy of the automaton uses it.
+ * @param chars
+ *          The given Chars to set Chars to.
+ */
 void CellularAutomaton::setChars(Chars *chars)
 {
-    this->chars = chars;
+    this->chars.reset(chars);
 }
 
+/**
+ * Sets Colors to the given Colors, deleting the old Colors once no copy of the automaton uses it.
+ * @param colors
+ *          The given Colors to set Colors to.
+ */
 void CellularAutomaton::setColors(Colors *colors)
 {
-    this->colors = colors;
+    this->colors.reset(colors);
 }
 
+/**
+ * Sets Initial to the given Initial, deleting the old Initial once no copy of the automaton uses it.
+ * @param initial
+ *          The given Initial to set Initial to.
+ */
 void CellularAutomaton::setInitial(Initial *initial)
 {
-    this->initial = initial;
+    this->initial.reset(initial);
 }
 
 /**
@@ -159,9 +175,13 @@ void CellularAutomaton::setInitial(Initial *initial)
  */
 void CellularAutomaton::updateWindow(string xRange, string yRange)
 {
+    if((!xRange.empty() || !yRange.empty()) && window.use_count() > 1) //copies of the automaton keep their window
+    {
+        window = make_shared<Range>(*window);
+    }
     if(!xRange.empty() && !yRange.empty()) //both ranges are not empty
     {
-        if(window == NULL) window = new Range();
+        if(window == NULL) window = make_shared<Range>();
         window->updateRange(xRange, yRange);
     }
     else if(!xRange.empty() || !yRange.empty()) //one of the ranges is empty
@@ -174,7 +194,7 @@ void CellularAutomaton::updateWindow(string xRange, string yRange)
         {
             yRange = terrain->rangeStr(terrain->getYStart(), terrain->getYEnd());
         }
-        if(window == NULL) window = new Range();
+        if(window == NULL) window = make_shared<Range>();
         window->updateRange(xRange, yRange);
     }
 }
@@ -189,9 +209,22 @@ void CellularAutomaton::updateWindow(string xRange, string yRange)
  */
 void CellularAutomaton::updateTerrain(string xRange, string yRange)
 {
+    if(terrain.use_count() > 1) terrain = make_shared<Range>(*terrain); //copies of the automaton keep their terrain
     terrain->updateRange(xRange, yRange);
 }
 
+/**
+ * Sets the initial cells to the given world cells converted to terrain positions. A copy of
+ * the initial is made first if it is shared with a copy of the automaton.
+ * @param worldCells
+ *              The cells with world positions.
+ */
+void CellularAutomaton::updateInitial(vector<Cell> worldCells)
+{
+    if(initial.use_count() > 1) initial.reset(initial->clone());
+    initial->convertToTerrainCells(worldCells, terrain.get());
+}
+
 /**
  * Sets the name of the automaton.
  * @param name
@@ -207,10 +240,10 @@ void CellularAutomaton::setName(string name)
  */
 void CellularAutomaton::setToDefaults()
 {
-    terrain = NULL;
-    window = NULL;
-    chars = NULL;
-    colors = NULL;
-    initial = NULL;
+    terrain.reset();
+    window.reset();
+    chars.reset();
+    colors.reset();
+    initial.reset();
     name = "";
 }
@@ -1,4 +1,5 @@
 #include "color.h"
+#include "automatonparser.h"
 #include <sstream>
 #include <iostream>
 
@@ -187,7 +188,7 @@ void Color::checkChannelRange(int value, string channel)
 {
     if(value < 0 || value > 255)
     {
-        cerr << "Invalid color channel value, " << value << ", for " << channel << "channel.\n";
+        AutomatonParser::errors() << "Invalid color channel value, " << value << ", for " << channel << "channel.\n";
         throw InvalidColorException;
     }
 }
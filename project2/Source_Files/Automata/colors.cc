@@ -1,4 +1,5 @@
 #include "colors.h"
+#include "automatonparser.h"
 #include "stdlib.h"
 #include <sstream>
 #include <iostream>
@@ -114,7 +115,7 @@ int Colors::convertStrToColorChannel(string &str, string &colorStr, char lCh, ch
     int leftIndex = str.find(lCh);
     if(leftIndex == string::npos)
     {
-        cerr << "Color is not in format of (red, green, blue): " << colorStr << endl;
+        AutomatonParser::errors() << "Color is not in format of (red, green, blue): " << colorStr << endl;
         throw InvalidColorException;
     }
     str = str.substr(leftIndex + 1, str.length());
@@ -122,7 +123,7 @@ int Colors::convertStrToColorChannel(string &str, string &colorStr, char lCh, ch
     int rightIndex = str.find(rCh);
     if(rightIndex == string::npos)
     {
-        cerr << "Color is not in format of (red, green, blue): " << colorStr << endl;
+        AutomatonParser::errors() << "Color is not in format of (red, green, blue): " << colorStr << endl;
         throw InvalidColorException;
     }
 
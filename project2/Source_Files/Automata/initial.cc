@@ -1,5 +1,7 @@
 #include "initial.h"
+#include "automatonparser.h"
 #include <iostream>
+#include <algorithm>
 
 /**
  * Implementation of initial.h
@@ -112,6 +114,7 @@ bool Initial::contains(int x, int y)
 
 /**
  * Initializes the initial object with a given terrain range and string of cells in the form of (cell, cell, cell,...).
+ * A cell that is already in the initial cells is not added again.
  * @param initialCells
  *              The string of cells.
  * @param terrain
@@ -121,22 +124,24 @@ bool Initial::contains(int x, int y)
  * @throws InvalidInitialValueException
  *              If there is a comma missing between cells.
  */
-void Initial::convertCellStr(string initialCells, Range *terrain, State state)
+void Initial::convertCellStr(const string &initialCells, Range *terrain, State state)
 {
     if(initialCells.empty()) return;
-    string temp = initialCells;
-    string cell = extractCellStr(temp);
+    size_t firstNew = cells.size();
+    size_t pos = 0; //the cells before pos have been added, which saves copying the rest of the string for each cell
+    string cell = extractCellStr(initialCells, pos);
     addCellFromCellStr(cell, terrain, state);
-    int comma = temp.empty() ? string::npos : 0;
-    while(comma == 0) //loops until there are no more cells in cell string
+    size_t comma = pos == initialCells.length() ? string::npos : pos;
+    while(comma == pos) //loops until there are no more cells in cell string
     {
-        cell = extractCellStr(temp);
+        cell = extractCellStr(initialCells, pos);
         addCellFromCellStr(cell, terrain, state);
-        comma = temp.find(",");
+        comma = initialCells.find(",", pos);
     }
+    removeDuplicates(firstNew);
     if(comma != string::npos)
     {
-        cerr << "Initial value is not formatted as Identifier = (x0,y0),(x1,y1),(x2,y2)...: " << initialCells << endl;
+        AutomatonParser::errors() << "Initial value is not formatted as Identifier = (x0,y0),(x1,y1),(x2,y2)...: " << initialCells << endl;
         throw InvalidInitialValueException;
     }
 }
@@ -213,29 +218,30 @@ int Initial::fitToTerrain(int pos, int start, int end)
  * @throws InvalidInitialValueException
  *              If the cell is missing the left bracket '(' or the right bracket ')'
  */
-string Initial::extractCellStr(string &initialCells)
+string Initial::extractCellStr(const string &initialCells, size_t &pos)
 {
-    int leftIndex = initialCells.find("(");
+    size_t leftIndex = initialCells.find("(", pos);
     if(leftIndex == string::npos)
     {
-        cerr << "Initial value is not formatted as Identifier = (x0,y0),(x1,y1),(x2,y2)...: " << initialCells << endl;
+        AutomatonParser::errors() << "Initial value is not formatted as Identifier = (x0,y0),(x1,y1),(x2,y2)...: " << initialCells.substr(pos) << endl;
         throw InvalidInitialValueException;
     }
 
-    int rightIndex = initialCells.find(")");
+    size_t rightIndex = initialCells.find(")", pos);
     if(rightIndex == string::npos)
     {
-        cerr << "Initial value is not formatted as Identifier = (x0,y0),(x1,y1),(x2,y2)...: " << initialCells << endl;
+        AutomatonParser::errors() << "Initial value is not formatted as Identifier = (x0,y0),(x1,y1),(x2,y2)...: " << initialCells.substr(pos) << endl;
         throw InvalidInitialValueException;
     }
 
     string cell = initialCells.substr(leftIndex + 1, (rightIndex - leftIndex) - 1);
-    initialCells = initialCells.substr(rightIndex + 1, initialCells.length());
+    pos = rightIndex + 1;
     return cell;
 }
 
 /**
- * Add cell from a cell string to the initial cells if it is not already in the initial cells.
+ * Add cell from a cell string to the initial cells. Cells that are already in the initial cells
+ * are removed by removeDuplicates.
  * @param cellStr
  *              The cell string.
  * @param terrain
@@ -255,7 +261,7 @@ void Initial::addCellFromCellStr(string &cellStr, Range *terrain, State state)
     int comma = cellStr.find(",");
     if(comma == string::npos)
     {
-        cerr << "Cell is not formatted as (x,y): (" << cellStr << ")" << endl;
+        AutomatonParser::errors() << "Cell is not formatted as (x,y): (" << cellStr << ")" << endl;
         throw InvalidInitialValueException;
     }
 
@@ -264,9 +270,41 @@ void Initial::addCellFromCellStr(string &cellStr, Range *terrain, State state)
 
     xPos = fitToTerrain(xPos, xStart, xEnd);
     yPos = fitToTerrain(yPos, yStart, yEnd);
-    if(!contains(xPos, yPos)) //if the cell is not already in the cell vector, add it
+    Cell cell(xPos, yPos, state);
+    cells.push_back(cell);
+}
+
+/**
+ * Removes the cells added since the given position that are at the same position as an earlier
+ * cell, keeping the order of the rest. The cells are sorted by position to find them, instead of
+ * searching the cells for each new cell.
+ * @param firstNew
+ *              The position of the first cell that was added.
+ */
+void Initial::removeDuplicates(size_t firstNew)
+{
+    if(cells.size() == firstNew) return;
+
+    //sorts the positions of the cells, keeping cells at the same position in the order they were added
+    vector<unsigned int> order(cells.size());
+    for(unsigned int i = 0; i < order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b)
+    {
+        return cells[a].getX() != cells[b].getX() ? cells[a].getX() < cells[b].getX() : cells[a].getY() < cells[b].getY();
+    });
+
+    vector<bool> duplicate(cells.size(), false);
+    for(unsigned int i = 1; i < order.size(); i++)
+    {
+        Cell &previous = cells[order[i - 1]];
+        Cell &cell = cells[order[i]];
+        if(cell.getX() == previous.getX() && cell.getY() == previous.getY()) duplicate[order[i]] = true;
+    }
+
+    size_t kept = firstNew; //only new cells can be duplicates, since the earlier cells were checked when they were added
+    for(size_t i = firstNew; i < cells.size(); i++)
     {
-        Cell cell(xPos, yPos, state);
-        cells.push_back(cell);
+        if(!duplicate[i]) cells[kept++] = cells[i];
     }
+    cells.resize(kept);
 }
@@ -230,7 +230,7 @@ void Range::update(string range, int &start, int &end)
     int dotIndex = temp.find(".");
     if(dotIndex == string::npos) //if no dots, the range is invalid
     {
-        cerr << "Invalid range: " << range << endl;
+        AutomatonParser::errors() << "Invalid range: " << range << endl;
         throw InvalidRangeException;
     }
     string low = temp.substr(0, dotIndex);
@@ -239,7 +239,7 @@ void Range::update(string range, int &start, int &end)
     dotIndex = temp.find(".");
     if(dotIndex == string::npos) //if no dots, the range is invalid
     {
-        cerr << "Invalid range: " << range << endl;
+        AutomatonParser::errors() << "Invalid range: " << range << endl;
         throw InvalidRangeException;
     }
     string high = temp.substr(dotIndex + 1, temp.length());
@@ -248,7 +248,7 @@ void Range::update(string range, int &start, int &end)
     end = atoi(high.c_str());
     if(start > end) //if the start value is greater than the end value, the range is invalid
     {
-        cerr << "Invalid range: " << range << ";low: " << start << ";high: " << end << endl;
+        AutomatonParser::errors() << "Invalid range: " << range << ";low: " << start << ";high: " << end << endl;
         throw InvalidRangeException;
     }
 }
@@ -9,6 +9,21 @@
  * @author Alex Cole
  */
 
+/**
+ * time in milliseconds spent simulating before returning to the event loop while catching up
+ */
+const int CatchUpSliceTime = 30;
+
+/**
+ * time in milliseconds between interim frames while catching up
+ */
+const int CatchUpFrameTime = 500;
+
+/**
+ * number of cells simulated between checks of the slice time
+ */
+const int CatchUpSliceCells = 16384;
+
  /**
   * Default constructor that sets up the control dialog.
   * @param parent
@@ -20,6 +35,10 @@ Control::Control(QWidget *parent)
     delay = 4000;
     timer = new QTimer(this);
     connect(timer, SIGNAL(timeout()), this, SLOT(playSimulation()));
+    catchUpTarget = 0;
+    catchUpTimer = new QTimer(this);
+    catchUpTimer->setInterval(0);
+    connect(catchUpTimer, SIGNAL(timeout()), this, SLOT(catchUp()));
 
     QHBoxLayout *gridSizeLayout = new QHBoxLayout;
     gridSizeLabel = new QLabel("Grid size: ");
@@ -51,8 +70,14 @@ Control::Control(QWidget *parent)
     QHBoxLayout *genLayout = new QHBoxLayout;
     genLabel = new QLabel("Generation: ");
     genNumLabel = new QLabel("0");
+    progress = new QProgressBar;
+    progress->hide();
+    cancel = new QPushButton("Cancel");
+    cancel->hide();
     genLayout->addWidget(genLabel);
     genLayout->addWidget(genNumLabel);
+    genLayout->addWidget(progress);
+    genLayout->addWidget(cancel);
 
     QHBoxLayout *buttonLayout = new QHBoxLayout;
     quit = new QPushButton("Quit");
@@ -67,6 +92,7 @@ Control::Control(QWidget *parent)
     connect(step, SIGNAL(clicked()), this, SLOT(stepClicked()));
     connect(restart, SIGNAL(clicked()), this, SLOT(restartClicked()));
     connect(play, SIGNAL(clicked()), this, SLOT(playClicked()));
+    connect(cancel, SIGNAL(clicked()), this, SLOT(cancelClicked()));
 
     QVBoxLayout *mainLayout = new QVBoxLayout;
     mainLayout->addLayout(gridSizeLayout);
@@ -88,7 +114,8 @@ Control::~Control() {}
  * @param world
  *              The cellular automaton world.
  * @param generations
- *              The initial generation.
+ *              The generation to catch up to. The world is simulated towards it in slices so
+ *              the window can be shown right away.
  * @param gridSize
  *              The size of the grid blocks in pixels.
  */
@@ -108,7 +135,17 @@ void Control::init(QApplication *app, World *world, int generations, int gridSiz
 
     gridSizeSpinBox->setValue(gridSize);
 
-    setGenNumLabel(generations);
+    setGenNumLabel(0);
+    if(generations > 0) //simulate up to the requested generation without blocking the event loop
+    {
+        catchUpTarget = generations;
+        progress->setRange(0, catchUpTarget);
+        progress->setValue(0);
+        progress->show();
+        cancel->show();
+        frameTimer.start();
+        catchUpTimer->start();
+    }
 
     connect(quit, SIGNAL(clicked()), app, SLOT(quit()));
 }
@@ -120,6 +157,7 @@ void Control::init(QApplication *app, World *world, int generations, int gridSiz
 void Control::stepClicked()
 {
     timer->stop();
+    stopCatchUp();
     simulateOneGen();
 }
 
@@ -130,6 +168,7 @@ void Control::stepClicked()
 void Control::restartClicked()
 {
     timer->stop();
+    stopCatchUp();
     setGenNumLabel(0);
     world->reset();
     updateWidget();
@@ -141,6 +180,7 @@ void Control::restartClicked()
  */
 void Control::playClicked()
 {
+    stopCatchUp();
     timer->start(delay);
 }
 
@@ -171,6 +211,59 @@ void Control::playSimulation()
     simulateOneGen();
 }
 
+/**
+ * Simulates a slice of the generations that still need to be caught up on, then returns
+ * to the event loop so the window stays responsive.
+ */
+void Control::catchUp()
+{
+    int gen = genNumLabelToInt();
+    int maxRows = CatchUpSliceCells / world->getCols();
+    if(maxRows < 1) maxRows = 1;
+
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+    while(gen < catchUpTarget && sliceTimer.elapsed() < CatchUpSliceTime)
+    {
+        if(world->simulateRows(maxRows)) gen++;
+    }
+    setGenNumLabel(gen);
+    progress->setValue(gen);
+
+    if(gen >= catchUpTarget)
+    {
+        stopCatchUp();
+        updateWidget();
+    }
+    else if(frameTimer.elapsed() >= CatchUpFrameTime) //show where the simulation is so far
+    {
+        updateWidget();
+        frameTimer.restart();
+    }
+}
+
+/**
+ * Cancels catching up to the requested generation. The world is left at the last
+ * generation that was completed.
+ */
+void Control::cancelClicked()
+{
+    stopCatchUp();
+    updateWidget();
+}
+
+/**
+ * Stops catching up to the requested generation and discards a partially simulated generation.
+ */
+void Control::stopCatchUp()
+{
+    if(!catchUpTimer->isActive()) return;
+    catchUpTimer->stop();
+    world->cancelRows();
+    progress->hide();
+    cancel->hide();
+}
+
 /**
  * Updates the widget based on changes made in the control dialog box.
  */
@@ -6,6 +6,9 @@
  * @author Alex Cole
  */
 
+//the error stream set by the thread, NULL for cerr
+static thread_local ostream *threadErrors = NULL;
+
 /**
  * Default constructor.
  */
@@ -19,7 +22,7 @@ AutomatonParser::~AutomatonParser() {}
 /**
  * Parses automaton file into key-value pairs. The key is the
  * identifier and the value could be a struct or other value specified after
- * the identifier.
+ * the identifier. The input is read in place, so only the values are copied.
  * @param input
  *              The automaton file with all comments and whitespace removed.
  * @return
@@ -27,33 +30,27 @@ AutomatonParser::~AutomatonParser() {}
  * @throws InvalidFileFormatException
  *              If the file is not properly formatted.
  */
-map<string, string> AutomatonParser::parse(string input)
+map<string, string> AutomatonParser::parse(const string &input)
 {
     map<string, string> data;
-    int keyBeginIndex = -1;
-    int keyEndIndex = -1;
-    int valueBeginIndex = -1;
-    int valueEndIndex = -1;
-    string key = "";
-    string value = "";
-
     if(!properFormat(input)) throw InvalidFileFormatException;
 
-    input = removeChar(input, '{', '}'); //removes struct brackets if there
+    size_t begin = 0;
+    size_t finish = input.length();
+    removeChar(input, begin, finish, '{', '}'); //skips struct brackets if there
 
-    while(hasKey(input))
+    size_t keyEndIndex = input.find('=', begin);
+    while(keyEndIndex < finish) //while there is a key in what has not been checked
     {
-        keyBeginIndex = 0;
-        keyEndIndex = input.find("=");
-        key = input.substr(keyBeginIndex, keyEndIndex - keyBeginIndex);
-
-        valueBeginIndex = keyEndIndex + 1;
-        valueEndIndex = findMatchingCharPos(input, '=', ';');
-        value = input.substr(valueBeginIndex, valueEndIndex - valueBeginIndex);
-        value = removeChar(value, '\"', '\"'); //removes surrounding quotes if there
-
-        data[key] = value;
-        input = input.substr(valueEndIndex + 1, input.length()); //removes what has already been checked
+        size_t terminator = findMatchingCharPos(input, begin, finish, '=', ';');
+        if(terminator == string::npos) throw InvalidFileFormatException;
+        size_t valueBeginIndex = keyEndIndex + 1;
+        size_t valueEndIndex = terminator;
+        removeChar(input, valueBeginIndex, valueEndIndex, '\"', '\"'); //skips surrounding quotes if there
+
+        data[input.substr(begin, keyEndIndex - begin)] = input.substr(valueBeginIndex, valueEndIndex - valueBeginIndex);
+        begin = terminator + 1; //skips what has already been checked
+        keyEndIndex = input.find('=', begin);
     }
     return data;
 }
@@ -67,238 +64,163 @@ map<string, string> AutomatonParser::parse(string input)
  * @param checkValue
  *              If the value of the identifier should be checked. Default is false.
  * @return
- *              The value of the key-value pair based on the given identifier.
+ *              The value of the key-value pair based on the given identifier, which stays
+ *              in the map.
  * @throws MissingIdentifierException
  *              If the given key identifier is not in the map.
  * @throws IdentifierHasNoValueException
  *              If checkValue is true and the key identifier does not have a value.
  */
-string AutomatonParser::getValue(map<string, string> &map, string identifier, bool checkValue)
+const string& AutomatonParser::getValue(map<string, string> &map, string identifier, bool checkValue)
 {
     if(map.find(identifier) == map.end())
     {
-        cerr << "Missing identifier: " << identifier << endl;
+        errors() << "Missing identifier: " << identifier << endl;
         throw MissingIdentifierException;
     }
-    string value = map[identifier];
+    const string &value = map[identifier];
     if(checkValue && value.empty())
     {
-        cerr << "Identifier is not assigned a value: " << identifier << endl;
+        errors() << "Identifier is not assigned a value: " << identifier << endl;
         throw IdentifierHasNoValueException;
     }
     return value;
 }
 
 /**
- * Checks to see if the input has a key.
- * @param input
- *              The string input.
+ * Gets the value from the map based on the key identifier and removes it from the map
+ * without copying it, so a large value such as the initial cells is only stored once.
+ * @param map
+ *              The map of key-value pairs.
+ * @param identifier
+ *              The key identifier.
+ * @param checkValue
+ *              If the value of the identifier should be checked. Default is false.
  * @return
- *              True if there is a key otherwise false.
+ *              The value of the key-value pair based on the given identifier.
+ * @throws MissingIdentifierException
+ *              If the given key identifier is not in the map.
+ * @throws IdentifierHasNoValueException
+ *              If checkValue is true and the key identifier does not have a value.
  */
-bool AutomatonParser::hasKey(string input)
+string AutomatonParser::takeValue(map<string, string> &map, string identifier, bool checkValue)
 {
-    return input.find("=") != string::npos;
+    getValue(map, identifier, checkValue);
+    string value;
+    value.swap(map[identifier]);
+    map.erase(identifier);
+    return value;
 }
 
 /**
- * Checks to see if the value is in correct automaton file format.
+ * Checks to see if the value is in correct automaton file format, which is when every
+ * { and = outside of quotes has a matching } and ;.
  * @param str
  *              The portion of the automaton file to be checked.
  * @return
  *              True if in proper format otherwise false.
  */
-bool AutomatonParser::properFormat(string str)
+bool AutomatonParser::properFormat(const string &str)
 {
-    string temp = removeQuotedStr(str); //remove quoted strings before checking format
-
-    //count how many starting char values there are and create arrays to store their position
-    int lBraceSize = countChar(temp, '{');
-    int equalSize = countChar(temp, '=');
-    int *lBraces = new int[lBraceSize];
-    int *equals = new int[equalSize];
-
-    //matches the starting characters with their terminating characters
-    bool validBraces = checkFormat(lBraces, lBraceSize, temp, '{', '}');
-    bool validAssignStmts = checkFormat(equals, equalSize, temp, '=', ';');
-
-    delete[] lBraces;
-    delete[] equals;
-
-    return validBraces && validAssignStmts; //if both are valid, the file is in valid format
-}
-
-/**
- * Counts the number of characters in a string.
- * @param str
- *              The string that the characters are going to be counted.
- * @param ch
- *              The character to count.
- * @return
- *              The number of the given character in the string.
- */
-int AutomatonParser::countChar(string str, char ch)
-{
-    int count = 0;
-    for(unsigned int i = 0; i < str.length(); i++)
+    bool quote = false;
+    bool matched = true;
+    int braces = 0; //the number of { and = waiting for a } and ;
+    int assignments = 0;
+    for(size_t i = 0; i < str.length(); i++)
     {
-        if(str[i] == ch) count++;
+        char ch = str[i];
+        if(ch == '\"') quote = !quote;
+        else if(quote) continue; //quoted strings are not checked
+        else if(ch == '{') braces++;
+        else if(ch == '=') assignments++;
+        else if(ch == '}') matched = braces-- > 0 && matched;
+        else if(ch == ';') matched = assignments-- > 0 && matched;
     }
-    return count;
-}
-
-/**
- * Checks to see if file has a terminating character for each initial character.
- * @param arr
- *              The positions of the initial characters.
- * @param length
- *              The length of the array.
- * @param str
- *              The string that the format needs to be checked.
- * @param start
- *              The initial character.
- * @param end
- *              The terminating character.
- * @return
- *              True if in correct format otherwise false.
- */
-bool AutomatonParser::checkFormat(int *arr, int length, string str, char start, char end)
-{
-    int arrPos = -1;
-    for(unsigned int i = 0; i < str.length(); i++)
-    {
-        if(str[i] == start) //if char is the starting char, add position to the array
-        {
-            arrPos++;
-            arr[arrPos] = i;
-        }
-        else if(str[i] == end) //if terminating char appears before a starting char, invalid format
-        {
-            if(arrPos == -1) return false;
+    if(quote) return true; //a quote that is never closed quotes the rest of the file, which leaves nothing to check
 
-            int pos = findMatchingCharPos(arr, arrPos + 1); //find the terminating char position
-            if(pos != -1) //if found set starting position to -1
-            {
-                arr[pos] = -1;
-            }
-            else //otherwise invalid format
-            {
-                return false;
-            }
-        }
-    }
-    return findMatchingCharPos(arr, length) < 0; //if all start chars were matched with terminating chars, then valid format
+    return matched && braces == 0 && assignments == 0; //if both are valid, the file is in valid format
 }
 
 /**
- * Finds the terminating character to the given start character.
+ * Finds the terminating character to the first start character in part of a string.
  * @param str
  *              The string to be checked.
+ * @param begin
+ *              The position of the start of the part.
+ * @param finish
+ *              The position after the end of the part.
  * @param start
  *              The starting character.
  * @param end
  *              The terminating character.
  * @return
- *              The position of the terminating character otherwise -1.
+ *              The position of the terminating character otherwise string::npos.
  */
-int AutomatonParser::findMatchingCharPos(string str, char start, char end)
+size_t AutomatonParser::findMatchingCharPos(const string &str, size_t begin, size_t finish, char start, char end)
 {
     int count = 0;
     bool found = false;
-    for(unsigned int i = 0; i < str.length(); i++)
+    for(size_t i = begin; i < finish; i++)
     {
-        if(str[i] == start && !found) //if the starting char and it has not been found previously, increase the count and set found to true
+        if(str[i] == start) //if the starting char, increase the count and note that it has been found
         {
             count++;
             found = true;
         }
-        else if(str[i] == start) //if the starting char, increase the count
-        {
-            count++;
-        }
         else if(str[i] == end && found)//if the terminating char and the starting char has been found, then decrease the count
         {
             count--;
             if(count == 0) return i; //if the count has been reduced to 0, then this is the matching position, so return it
         }
     }
-    return -1; //matching position was not found
+    return string::npos; //matching position was not found
 }
 
 /**
- * Finds the starting character position in the array for a terminating character.
- * @param arr
- *              An array of starting positions.
- * @param length
- *              The length of the array.
- * @return
- *              The position of the corresponding start character otherwise -1.
+ * Moves the bounds of part of a string inside of starting and terminating characters
+ * if the part starts and ends with them.
+ * @param str
+ *              The string the part is in.
+ * @param begin
+ *              The position of the start of the part.
+ * @param finish
+ *              The position after the end of the part.
+ * @param start
+ *              The start character to be removed.
+ * @param end
+ *              The end character to be removed.
  */
-int AutomatonParser::findMatchingCharPos(int *arr, int length)
+void AutomatonParser::removeChar(const string &str, size_t &begin, size_t &finish, char start, char end)
 {
-    for(int i = length - 1; i >= 0; i--) //looks through array in reverse until it finds a positive value, then returns that position
+    if(begin < finish && str[begin] == start && str[finish - 1] == end) //if the first character matches start and last matches end, remove them
     {
-        if(arr[i] >= 0) return i;
+        begin++;
+        if(begin < finish) finish--;
     }
-    return -1; //no positive values found in the array
 }
 
 /**
- * Removes a quoted string from the string.
- * @param str
- *              The string to have the quote removed from.
+ * Gets the stream problems found while reading settings and automata are reported to. It is cerr
+ * unless the calling thread has set its own stream with setErrors.
  * @return
- *              A string with no quoted strings in it.
+ *              The error stream of the calling thread.
  */
-string AutomatonParser::removeQuotedStr(string str)
+ostream& AutomatonParser::errors()
 {
-    while(str.find('\"') != string::npos) //checks for quote in the string
-    {
-        int leftQuote = -1;
-        int rightQuote = -1;
-        for(unsigned int i = 0; i < str.length(); i++)
-        {
-            if(str[i] == '\"' && leftQuote == -1) //finds left quote
-            {
-                leftQuote = i;
-            }
-            else if(str[i] == '\"') //finds right quote
-            {
-                rightQuote = i;
-                break;
-            }
-        }
-
-        if(leftQuote != -1 && rightQuote == -1) return ""; //returns empty string if left quote but no right quote. Invalid format
-
-        string left = str.substr(0, leftQuote);
-        string right = str.substr(rightQuote + 1, str.length());
-
-        str = left + right;
-    }
-    return str;
+    return threadErrors != NULL ? *threadErrors : cerr;
 }
 
 /**
- * Removes starting and terminating characters from a string.
- * @param str
- *              The string to have the characters removed.
- * @param start
- *              The start character to be removed.
- * @param end
- *              The end character to be removed.
+ * Sets the stream problems found while reading settings and automata on the calling thread are
+ * reported to, so jobs run on different threads each keep their own errors.
+ * @param err
+ *              The stream to report to, or NULL for cerr.
  * @return
- *              The string with the starting and terminating characters removed.
+ *              The stream that was set before, or NULL if it was cerr.
  */
-string AutomatonParser::removeChar(string str, char start, char end)
+ostream* AutomatonParser::setErrors(ostream *err)
 {
-    int lastPos = str.length() - 1;
-    if(str[0] == start && str[lastPos] == end) //if the first character matches start and last matches end, remove them
-    {
-        return str.substr(1, lastPos - 1);
-    }
-    else
-    {
-        return str;
-    }
+    ostream *previous = threadErrors;
+    threadErrors = err;
+    return previous;
 }
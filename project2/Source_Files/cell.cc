@@ -33,69 +33,6 @@ Cell::Cell(int x, int y, State state)
     this->state = state;
 }
 
-/**
- * Copy constructor.
- * @param cell
- *          The cell to be copied.
- */
-Cell::Cell(const Cell &cell)
-{
-    x = cell.x;
-    y = cell.y;
-    state = cell.state;
-}
-
-/**
- * Destructor
- */
-Cell::~Cell() {}
-
-/**
- * Overloaded assignment operator.
- * @param cell
- *          The cell to be copied.
- * @return
- *          A copy of the given cell.
- */
-Cell& Cell::operator=(const Cell &cell)
-{
-    if(this == &cell) return *this;
-    x = cell.x;
-    y = cell.y;
-    state = cell.state;
-    return *this;
-}
-
-/**
- * Gets the x position.
- * @return
- *          The x value.
- */
-int Cell::getX()
-{
-    return x;
-}
-
-/**
- * Gets the y position.
- * @return
- *          The y value.
- */
-int Cell::getY()
-{
-    return y;
-}
-
-/**
- * Gets the state.
- * @return
- *          The state of the cell.
- */
-State Cell::getState()
-{
-    return state;
-}
-
 /**
  * Sets the x position.
  * @param x
@@ -116,17 +53,6 @@ void Cell::setY(int y)
     this->y = y;
 }
 
-/**
- * Sets the state.
- * @param state
- *          The state the cell is to be set to.
- */
-void Cell::setState(State state)
-{
-    this->state = state;
-}
-
-
 /**
  * Checks to see if cells are equal by only
  * comparing the x and y values.
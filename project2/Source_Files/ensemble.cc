@@ -0,0 +1,196 @@
+#include "ensemble.h"
+
+/**
+ * Implementation of ensemble.h
+ * @author Alex Cole
+ */
+
+/**
+ * Constructor that creates an ensemble with no instances.
+ * @param rows
+ *          The number of rows in each instance.
+ * @param columns
+ *          The number of columns in each instance.
+ * @param bornMask
+ *          Bit n is set if n alive neighbors cause a cell to be born.
+ * @param stayAliveMask
+ *          Bit n is set if n alive neighbors cause a cell to stay alive.
+ */
+Ensemble::Ensemble(int rows, int columns, int bornMask, int stayAliveMask)
+{
+    this->rows = rows;
+    this->columns = columns;
+    this->instances = 0;
+    this->bornMask = bornMask;
+    this->stayAliveMask = stayAliveMask;
+    cells.assign((size_t) rows * columns, 0);
+    nextCells.assign((size_t) rows * columns, 0);
+}
+
+/**
+ * Destructor
+ */
+Ensemble::~Ensemble() {}
+
+/**
+ * Adds an instance with all cells dead.
+ * @return
+ *          The index of the instance or -1 if the ensemble is full.
+ */
+int Ensemble::addInstance()
+{
+    if(instances == MaxInstances) return -1;
+    return instances++;
+}
+
+/**
+ * Gets the number of instances.
+ * @return
+ *          The number of instances.
+ */
+int Ensemble::size()
+{
+    return instances;
+}
+
+/**
+ * Sets a cell to alive in an instance.
+ * @param instance
+ *          The index of the instance.
+ * @param row
+ *          The row of the cell.
+ * @param col
+ *          The column of the cell.
+ */
+void Ensemble::setAlive(int instance, int row, int col)
+{
+    cells[(size_t) row * columns + col] |= 1ULL << instance;
+}
+
+/**
+ * Checks if a cell is alive in an instance.
+ * @param instance
+ *          The index of the instance.
+ * @param row
+ *          The row of the cell.
+ * @param col
+ *          The column of the cell.
+ * @return
+ *          True if the cell is alive otherwise false.
+ */
+bool Ensemble::isAlive(int instance, int row, int col)
+{
+    return (cells[(size_t) row * columns + col] >> instance) & 1;
+}
+
+/**
+ * Simulates one generation of every instance.
+ */
+void Ensemble::step()
+{
+    unsigned long long active = activeInstances();
+    for(int row = 0; row < rows; row++)
+    {
+        int minusRow = (row - 1) < 0 ? rows - 1 : row - 1; //wrap around values
+        int plusRow = (row + 1) >= rows ? 0 : row + 1;
+        const unsigned long long *above = &cells[(size_t) minusRow * columns];
+        const unsigned long long *current = &cells[(size_t) row * columns];
+        const unsigned long long *below = &cells[(size_t) plusRow * columns];
+        unsigned long long *next = &nextCells[(size_t) row * columns];
+
+        for(int col = 0; col < columns; col++)
+        {
+            int minusCol = (col - 1) < 0 ? columns - 1 : col - 1;
+            int plusCol = (col + 1) >= columns ? 0 : col + 1;
+            unsigned long long neighbors[8] = { above[minusCol], above[col], above[plusCol], current[minusCol],
+                current[plusCol], below[minusCol], below[col], below[plusCol] };
+
+            //adds each neighbor into a 4 bit counter per instance, bit k of sn is bit n of the count of instance k
+            unsigned long long s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            for(int i = 0; i < 8; i++)
+            {
+                unsigned long long carry0 = s0 & neighbors[i];
+                s0 ^= neighbors[i];
+                unsigned long long carry1 = s1 & carry0;
+                s1 ^= carry0;
+                unsigned long long carry2 = s2 & carry1;
+                s2 ^= carry1;
+                s3 |= carry2;
+            }
+
+            //a born count makes a cell alive whatever its state, as in Life::nextCellState
+            unsigned long long born = countIn(bornMask, s0, s1, s2, s3);
+            unsigned long long stayAlive = countIn(stayAliveMask, s0, s1, s2, s3) & current[col];
+            next[col] = (born | stayAlive) & active;
+        }
+    }
+    cells.swap(nextCells);
+}
+
+/**
+ * Gets the instances that have at least one alive cell.
+ * @return
+ *          A word where bit k is set if instance k has an alive cell.
+ */
+unsigned long long Ensemble::aliveInstances()
+{
+    unsigned long long alive = 0;
+    for(size_t i = 0; i < cells.size(); i++)
+    {
+        alive |= cells[i];
+    }
+    return alive;
+}
+
+/**
+ * Gets the population of every instance.
+ * @param populations
+ *          Filled with the number of alive cells in each instance.
+ */
+void Ensemble::getPopulations(vector<int> &populations)
+{
+    populations.assign(instances, 0);
+    for(size_t i = 0; i < cells.size(); i++)
+    {
+        for(unsigned long long word = cells[i]; word != 0; word &= word - 1) //visits each set bit
+        {
+            populations[__builtin_ctzll(word)]++;
+        }
+    }
+}
+
+/**
+ * Gets a word that has the bits of the instances that are in use set.
+ * @return
+ *          The word with the bit of each instance set.
+ */
+unsigned long long Ensemble::activeInstances()
+{
+    return instances == MaxInstances ? ~0ULL : (1ULL << instances) - 1;
+}
+
+/**
+ * Gets the instances whose neighbor count is in a mask of counts.
+ * @param counts
+ *          Bit n is set if a count of n matches.
+ * @param s0
+ *          Bit 0 of the neighbor count of each instance.
+ * @param s1
+ *          Bit 1 of the neighbor count of each instance.
+ * @param s2
+ *          Bit 2 of the neighbor count of each instance.
+ * @param s3
+ *          Bit 3 of the neighbor count of each instance.
+ * @return
+ *          A word where bit k is set if the neighbor count of instance k is in the mask.
+ */
+unsigned long long Ensemble::countIn(int counts, unsigned long long s0, unsigned long long s1, unsigned long long s2, unsigned long long s3)
+{
+    unsigned long long ret = 0;
+    for(int n = 0; n <= 8; n++)
+    {
+        if(!((counts >> n) & 1)) continue;
+        ret |= ((n & 1) ? s0 : ~s0) & ((n & 2) ? s1 : ~s1) & ((n & 4) ? s2 : ~s2) & ((n & 8) ? s3 : ~s3);
+    }
+    return ret;
+}
@@ -1,11 +1,6 @@
 #include <iostream>
-#include <fstream>
 #include "settings.h"
-#include "lifeclass.h"
-#include "elementary.h"
-#include "brian.h"
-#include "world.h"
-#include "automatonparser.h"
+#include "lifejob.h"
 
 /**
  * life program that displays cellular automaton as a file or ascii grid
@@ -36,80 +31,15 @@ int main(int argc, char* argv[])
         cout << "-ty l..h sets the y range for the terrain in the format of low to high (low..high), which overrides the terrain values in input.\n";
         cout << "-v Sends output to cout or standard out in the format of an ascii grid\n";
         cout << "-wx l..h sets the x range for the window in the format of low to high (low..high), which overrides the window values in input.\n";
-        cout << "-wy l..h sets the y range for the window in the format of low to high (low..high), which overrides the window values in input.\n\n";
+        cout << "-wy l..h sets the y range for the window in the format of low to high (low..high), which overrides the window values in input.\n";
+        cout << "-stats file writes the time taken by each phase and generation, and the changed cells and population of each generation to file. The file is JSON if it ends in .json otherwise it is CSV.\n";
+        cout << "-block n simulates n generations at a time on each cache sized tile of the world, which is faster for large worlds. 1 by default.\n";
+        cout << "-perf adds cycles, instructions, IPC, cache misses and branch misses of each generation and of rendering to the -stats file when hardware counters are available. Requires -stats.\n\n";
         cout << "Window values whether given in input on or command line with take precedence over terrain values when world is displayed as ascii characters.\n";
         cout << "By default output is in the form of -v flag and a name is not required for input. If initial struct is not specified, then all cells will be set to dead.\n";
         return 0;
     }
 
-    if(settings.getInFile().empty()) //no file specified, then read from cin
-    {
-        if(settings.stripWhitespaceAndComments(cin) != 0)
-        {
-            cerr << "problem reading from standard input\n";
-            return -1;
-        }
-    }
-    else
-    {
-        ifstream in(settings.getInFile());
-        if(settings.stripWhitespaceAndComments(in) != 0)
-        {
-            cerr << "problem reading from file: " << settings.getInFile() << "\n";
-            return -1;
-        }
-        in.close();
-    }
-
-    CellularAutomaton *automaton = NULL;
-    World *world = NULL;
-    try
-    {
-        map<string, string> automatonStruct = AutomatonParser::parse(settings.getInput());
-        if(!automatonStruct["Life"].empty())
-        {
-            automaton = new Life(automatonStruct["Life"]);
-        }
-        else if(!automatonStruct["Elementary"].empty())
-        {
-            automaton = new Elementary(automatonStruct["Elementary"]);
-        }
-        else if(!automatonStruct["Brian"].empty())
-        {
-            automaton = new Brian(automatonStruct["Brian"]);
-        }
-        else
-        {
-            cerr << "File does not contain valid cellular automaton: " << settings.getInFile() << endl;
-            return -1;
-        }
-        automaton->updateTerrain(settings.getTX(), settings.getTY());
-        automaton->updateWindow(settings.getWX(), settings.getWY());
-        world = new World(automaton);
-        world->simulate(settings.getGenerations());
-    }
-    catch(int e)
-    {
-        if(e == InvalidFileFormatException)
-        {
-            cerr << "File is not in valid life file format: " << settings.getInFile() << endl;
-        }
-        delete automaton;
-        delete world;
-        return -1;
-    }
-
-    if(settings.fileFormat())
-    {
-        cout << world->getAutomaton()->toString(); //-f
-    }
-    else
-    {
-        cout << world->toString(); //-v or if no flag specified
-    }
-    cout << endl;
-
-    delete automaton;
-    delete world;
-    return 0;
+    LifeJob job(settings);
+    return job.run(cout, cerr);
 }
@@ -0,0 +1,717 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <mutex>
+#include <map>
+#include <algorithm>
+#include <stdlib.h>
+#include "string.h"
+#include "settings.h"
+#include "lifejob.h"
+#include "threadpool.h"
+#include "rulesweep.h"
+#include "automatonparser.h"
+#include "ensemble.h"
+#include "lifeclass.h"
+#include "world.h"
+
+/**
+ * lifebatch program that runs many life jobs from a manifest at the same time
+ * @author Alex Cole
+ */
+
+/**
+ * A job from the manifest and what it printed.
+ */
+struct BatchJob
+{
+    int lineNumber;
+    string line;
+    int status;
+    string output;
+    string error;
+    bool done;
+};
+
+/**
+ * Where the results of the jobs are written. Per-job files are written as soon as a job is done,
+ * the combined JSONL stream is written in manifest order as soon as all earlier jobs are done.
+ */
+struct BatchOutput
+{
+    string dir;
+    ostream *jsonl;
+    vector<BatchJob> *jobs;
+    unsigned int nextJob;
+    mutex lock;
+};
+
+/**
+ * The summaries of a rule sweep, which are written in rule order as soon as all earlier rules are done.
+ */
+struct SweepOutput
+{
+    ostream *jsonl;
+    vector<RuleSummary> summaries;
+    vector<bool> done;
+    unsigned int next;
+    mutex lock;
+};
+
+/**
+ * A Life-like world from an ensemble manifest and the statistics of its simulation.
+ */
+struct EnsembleMember
+{
+    int lineNumber;
+    string line;
+    int status;
+    string error;
+    int rows;
+    int columns;
+    int bornMask;
+    int stayAliveMask;
+    int generations;
+    vector<pair<int, int>> alive;
+    int population;
+    int extinct;
+};
+
+/**
+ * Gets the position of a flag.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ * @param flag
+ *          The flag to get the position of.
+ * @return
+ *          The position of the last occurrence of the flag otherwise -1.
+ */
+int flagPos(int argc, char *argv[], const char *flag)
+{
+    int pos = -1;
+    for(int i = 1; i < argc; i++)
+    {
+        if(0 == strcmp(argv[i], flag)) pos = i;
+    }
+    return pos;
+}
+
+/**
+ * Gets the value given after a flag.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ * @param flag
+ *          The flag to get the value of.
+ * @return
+ *          The value after the flag otherwise an empty string.
+ */
+string flagValue(int argc, char *argv[], const char *flag)
+{
+    int pos = flagPos(argc, argv, flag);
+    return pos != -1 && pos + 1 < argc ? argv[pos + 1] : "";
+}
+
+/**
+ * Reads the jobs from a manifest. Each line is an automaton file followed by any life switches, such as
+ * -g, -tx, -ty, -wx, -wy and -f. Empty lines and lines starting with # are skipped.
+ * @param in
+ *          The stream to read the manifest from.
+ * @param jobs
+ *          The jobs read from the manifest.
+ */
+void readManifest(istream &in, vector<BatchJob> &jobs)
+{
+    string line;
+    int lineNumber = 0;
+    while(getline(in, line))
+    {
+        lineNumber++;
+        unsigned int i = 0;
+        while(i < line.length() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+        if(i == line.length() || line[i] == '#') continue;
+
+        BatchJob job;
+        job.lineNumber = lineNumber;
+        job.line = line;
+        job.status = -1;
+        job.done = false;
+        jobs.push_back(job);
+    }
+}
+
+/**
+ * Escapes a string so it can be used as a JSON string value.
+ * @param str
+ *          The string to escape.
+ * @return
+ *          The escaped string without surrounding quotes.
+ */
+string escapeJSON(const string &str)
+{
+    string ret;
+    for(unsigned int i = 0; i < str.length(); i++)
+    {
+        char ch = str[i];
+        if(ch == '"') ret += "\\\"";
+        else if(ch == '\\') ret += "\\\\";
+        else if(ch == '\n') ret += "\\n";
+        else if(ch == '\t') ret += "\\t";
+        else if(ch == '\r') ret += "\\r";
+        else if((unsigned char) ch < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", ch);
+            ret += code;
+        }
+        else ret += ch;
+    }
+    return ret;
+}
+
+/**
+ * Runs one job with its own settings, automaton and world.
+ * @param job
+ *          The job to run.
+ */
+void runJob(BatchJob &job)
+{
+    //split the line into arguments as if they were given to life
+    vector<string> args;
+    args.push_back("life");
+    istringstream in(job.line);
+    string arg;
+    while(in >> arg) args.push_back(arg);
+    vector<char*> argv;
+    for(unsigned int i = 0; i < args.size(); i++) argv.push_back(&args[i][0]);
+
+    ostringstream out;
+    ostringstream err;
+    ostream *previous = AutomatonParser::setErrors(&err); //problems reading the job go in its own error
+    try
+    {
+        Settings settings;
+        settings.init(argv.size(), &argv[0]);
+        if(settings.getInFile().empty())
+        {
+            err << "no readable automaton file in manifest line " << job.lineNumber << "\n";
+        }
+        else
+        {
+            LifeJob lifeJob(settings);
+            job.status = lifeJob.run(out, err);
+        }
+    }
+    catch(int e)
+    {
+        job.status = -1;
+    }
+    catch(...)
+    {
+        err << "job failed unexpectedly\n";
+        job.status = -1;
+    }
+    AutomatonParser::setErrors(previous);
+    job.output = out.str();
+    job.error = err.str();
+}
+
+/**
+ * Reads, parses and creates the world of an ensemble member, keeping only its alive cells, rule, terrain
+ * size and generations.
+ * @param member
+ *          The member to read.
+ */
+void readMember(EnsembleMember &member)
+{
+    vector<string> args;
+    args.push_back("life");
+    istringstream in(member.line);
+    string arg;
+    while(in >> arg) args.push_back(arg);
+    vector<char*> argv;
+    for(unsigned int i = 0; i < args.size(); i++) argv.push_back(&args[i][0]);
+
+    ostringstream err;
+    ostream *previous = AutomatonParser::setErrors(&err); //problems reading the member go in its own error
+    CellularAutomaton *automaton = NULL;
+    World *world = NULL;
+    try
+    {
+        Settings settings;
+        settings.init(argv.size(), &argv[0]);
+        if(settings.getInFile().empty())
+        {
+            err << "no readable automaton file in manifest line " << member.lineNumber << "\n";
+        }
+        else
+        {
+            LifeJob job(settings);
+            automaton = job.createAutomaton(err);
+            Life *life = dynamic_cast<Life*>(automaton);
+            if(automaton != NULL && life == NULL)
+            {
+                err << "Ensembles can only be simulated for Life-like automata: " << settings.getInFile() << endl;
+            }
+            else if(life != NULL)
+            {
+                world = new World(automaton);
+                member.rows = world->getRows();
+                member.columns = world->getCols();
+                member.bornMask = life->getBornMask();
+                member.stayAliveMask = life->getStayAliveMask();
+                member.generations = settings.getGenerations();
+                vector<vector<Cell>> grid = world->getWorld();
+                for(int row = 0; row < member.rows; row++)
+                {
+                    for(int col = 0; col < member.columns; col++)
+                    {
+                        if(grid[row][col].getState() == State::ALIVE) member.alive.push_back(make_pair(row, col));
+                    }
+                }
+                member.status = 0;
+            }
+        }
+    }
+    catch(int e)
+    {
+        if(e == InvalidFileFormatException)
+        {
+            err << "File is not in valid life file format: " << member.line << endl;
+        }
+    }
+    catch(...)
+    {
+        err << "job failed unexpectedly\n";
+    }
+    AutomatonParser::setErrors(previous);
+    delete world;
+    delete automaton;
+    member.error = err.str();
+}
+
+/**
+ * Simulates up to 64 members with the same rule, terrain size and generations in one ensemble, recording
+ * the final population of each member and the generation it died out in.
+ * @param members
+ *          The members of the ensemble.
+ */
+void runEnsemble(vector<EnsembleMember*> members)
+{
+    EnsembleMember &first = *members[0];
+    Ensemble ensemble(first.rows, first.columns, first.bornMask, first.stayAliveMask);
+    unsigned long long living = 0;
+    for(unsigned int i = 0; i < members.size(); i++)
+    {
+        int instance = ensemble.addInstance();
+        for(unsigned int j = 0; j < members[i]->alive.size(); j++)
+        {
+            ensemble.setAlive(instance, members[i]->alive[j].first, members[i]->alive[j].second);
+        }
+        members[i]->extinct = members[i]->alive.empty() ? 0 : -1;
+        if(!members[i]->alive.empty()) living |= 1ULL << instance;
+        members[i]->alive.clear();
+    }
+
+    //worlds that die out stay dead unless cells are born with no neighbors
+    bool revives = (first.bornMask & 1) != 0;
+    for(int generation = 1; generation <= first.generations && (living != 0 || revives); generation++)
+    {
+        ensemble.step();
+        unsigned long long alive = ensemble.aliveInstances();
+        for(unsigned long long died = living & ~alive; died != 0; died &= died - 1) //visits each instance that died this generation
+        {
+            members[__builtin_ctzll(died)]->extinct = generation;
+        }
+        living &= alive;
+    }
+
+    vector<int> populations;
+    ensemble.getPopulations(populations);
+    for(unsigned int i = 0; i < members.size(); i++) members[i]->population = populations[i];
+}
+
+/**
+ * Writes the result of a job that is done. Per-job output goes to a file named after the manifest line
+ * in the output directory. JSONL output is written for every job in order that is done.
+ * @param output
+ *          Where the results are written.
+ * @param job
+ *          The job that is done.
+ */
+void writeResult(BatchOutput &output, BatchJob &job)
+{
+    unique_lock<mutex> guard(output.lock);
+    job.done = true;
+    if(!job.error.empty())
+    {
+        cerr << "line " << job.lineNumber << ": " << job.error;
+        if(job.error[job.error.length() - 1] != '\n') cerr << "\n";
+    }
+
+    if(!output.dir.empty())
+    {
+        ostringstream name;
+        name << output.dir << "/" << job.lineNumber << ".out";
+        ofstream file(name.str());
+        file << job.output;
+        file.close();
+        if(file.fail())
+        {
+            cerr << "problem writing to file: " << name.str() << "\n";
+            job.status = -1;
+        }
+        if(output.jsonl == NULL) job.output.clear(); //nothing else needs it, so do not hold on to it
+    }
+
+    if(output.jsonl != NULL)
+    {
+        vector<BatchJob> &jobs = *output.jobs;
+        while(output.nextJob < jobs.size() && jobs[output.nextJob].done)
+        {
+            BatchJob &next = jobs[output.nextJob];
+            *output.jsonl << "{\"line\": " << next.lineNumber << ", \"args\": \"" << escapeJSON(next.line) << "\", \"status\": " << next.status
+                          << ", \"output\": \"" << escapeJSON(next.output) << "\", \"error\": \"" << escapeJSON(next.error) << "\"}\n";
+            next.output.clear();
+            output.nextJob++;
+        }
+        output.jsonl->flush();
+    }
+}
+
+/**
+ * Writes the summary of a rule that is done and any summaries after it that are done.
+ * @param output
+ *          Where the summaries are written.
+ * @param index
+ *          The index of the summary that is done.
+ * @param summary
+ *          The summary of the rule.
+ */
+void writeSummary(SweepOutput &output, unsigned int index, RuleSummary &summary)
+{
+    unique_lock<mutex> guard(output.lock);
+    output.summaries[index] = summary;
+    output.done[index] = true;
+    while(output.next < output.done.size() && output.done[output.next])
+    {
+        RuleSummary &next = output.summaries[output.next];
+        *output.jsonl << "{\"rule\": " << next.rule << ", \"name\": \"" << next.ruleStr << "\", \"population\": " << next.population
+                      << ", \"period\": " << next.period << ", \"stabilised\": " << next.stabilised << ", \"generations\": " << next.generations << "}\n";
+        output.next++;
+    }
+    output.jsonl->flush();
+}
+
+/**
+ * Simulates one automaton file under a range of rules at the same time on a pool of threads. The file is
+ * read and parsed once. Switches other than the lifebatch ones are applied to the file as life would.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ * @return
+ *          0 if the sweep was successful otherwise -1.
+ */
+int sweep(int argc, char *argv[])
+{
+    //the file goes first so life settings find it before any other file, the lifebatch switches are left out
+    vector<char*> lifeArgs;
+    lifeArgs.push_back(argv[0]);
+    lifeArgs.push_back(argv[flagPos(argc, argv, "-sweep") + 1]);
+    for(int i = 1; i < argc; i++)
+    {
+        if(0 == strcmp(argv[i], "-sweep") || 0 == strcmp(argv[i], "-rules") || 0 == strcmp(argv[i], "-j") || 0 == strcmp(argv[i], "-jsonl"))
+        {
+            i++;
+            continue;
+        }
+        lifeArgs.push_back(argv[i]);
+    }
+
+    CellularAutomaton *automaton = NULL;
+    RuleSweep *ruleSweep = NULL;
+    try
+    {
+        Settings settings;
+        settings.init(lifeArgs.size(), &lifeArgs[0]);
+        if(settings.getInFile().empty())
+        {
+            cerr << "problem reading from file: " << lifeArgs[1] << "\n";
+            return -1;
+        }
+        LifeJob job(settings);
+        automaton = job.createAutomaton(cerr);
+        if(automaton == NULL) return -1;
+        RuleAutomaton *ruleAutomaton = dynamic_cast<RuleAutomaton*>(automaton);
+        if(ruleAutomaton == NULL)
+        {
+            cerr << "Rules can only be swept for Life-like and Elementary automata" << endl;
+            delete automaton;
+            return -1;
+        }
+        ruleSweep = new RuleSweep(ruleAutomaton, flagPos(argc, argv, "-g") != -1 ? settings.getGenerations() : 1000);
+    }
+    catch(int e)
+    {
+        if(e == InvalidFileFormatException)
+        {
+            cerr << "File is not in valid life file format: " << lifeArgs[1] << endl;
+        }
+        delete automaton;
+        return -1;
+    }
+
+    int low = 0;
+    int high = ruleSweep->numRules() - 1;
+    string rules = flagValue(argc, argv, "-rules");
+    if(!rules.empty() && (sscanf(rules.c_str(), "%d..%d", &low, &high) != 2 || low < 0 || high >= ruleSweep->numRules() || low > high))
+    {
+        cerr << "Invalid rule range: " << rules << ", rules must be within 0.." << ruleSweep->numRules() - 1 << endl;
+        delete ruleSweep;
+        delete automaton;
+        return -1;
+    }
+
+    SweepOutput output;
+    output.summaries.resize(high - low + 1);
+    output.done.resize(high - low + 1, false);
+    output.next = 0;
+    output.jsonl = &cout;
+    ofstream jsonlFile;
+    string jsonlName = flagValue(argc, argv, "-jsonl");
+    if(!jsonlName.empty())
+    {
+        jsonlFile.open(jsonlName);
+        if(!jsonlFile.is_open())
+        {
+            cerr << "problem writing to file: " << jsonlName << "\n";
+            delete ruleSweep;
+            delete automaton;
+            return -1;
+        }
+        output.jsonl = &jsonlFile;
+    }
+
+    string threads = flagValue(argc, argv, "-j");
+    {
+        ThreadPool pool(threads.empty() ? 0 : atoi(threads.c_str()));
+        for(int rule = low; rule <= high; rule++)
+        {
+            pool.add([&output, ruleSweep, rule, low]()
+            {
+                RuleSummary summary = ruleSweep->run(rule);
+                writeSummary(output, rule - low, summary);
+            });
+        }
+        pool.wait();
+    }
+
+    delete ruleSweep;
+    delete automaton;
+    return 0;
+}
+
+/**
+ * Simulates the Life-like worlds of a manifest in ensembles of up to 64 worlds that have the same rule,
+ * terrain size and generations, running the ensembles at the same time on a pool of threads.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ * @return
+ *          0 if every world was simulated otherwise -1.
+ */
+int ensembles(int argc, char *argv[])
+{
+    string manifestName = argv[flagPos(argc, argv, "-ensemble") + 1];
+    ifstream manifest(manifestName);
+    if(!manifest.is_open())
+    {
+        cerr << "problem reading from file: " << manifestName << "\n";
+        return -1;
+    }
+    vector<BatchJob> jobs;
+    readManifest(manifest, jobs);
+    manifest.close();
+
+    ostream *jsonl = &cout;
+    ofstream jsonlFile;
+    string jsonlName = flagValue(argc, argv, "-jsonl");
+    if(!jsonlName.empty())
+    {
+        jsonlFile.open(jsonlName);
+        if(!jsonlFile.is_open())
+        {
+            cerr << "problem writing to file: " << jsonlName << "\n";
+            return -1;
+        }
+        jsonl = &jsonlFile;
+    }
+
+    vector<EnsembleMember> members(jobs.size());
+    string threads = flagValue(argc, argv, "-j");
+    ThreadPool pool(threads.empty() ? 0 : atoi(threads.c_str()));
+    for(unsigned int i = 0; i < jobs.size(); i++)
+    {
+        EnsembleMember *member = &members[i];
+        member->lineNumber = jobs[i].lineNumber;
+        member->line = jobs[i].line;
+        member->status = -1;
+        member->population = 0;
+        member->extinct = -1;
+        pool.add([member]() { readMember(*member); });
+    }
+    pool.wait();
+
+    //members that can share an ensemble are grouped by rule, terrain size and generations
+    map<vector<int>, vector<EnsembleMember*>> groups;
+    for(unsigned int i = 0; i < members.size(); i++)
+    {
+        EnsembleMember &member = members[i];
+        if(member.status != 0) continue;
+        int key[] = { member.rows, member.columns, member.bornMask, member.stayAliveMask, member.generations };
+        groups[vector<int>(key, key + 5)].push_back(&member);
+    }
+    for(map<vector<int>, vector<EnsembleMember*>>::iterator it = groups.begin(); it != groups.end(); it++)
+    {
+        vector<EnsembleMember*> &group = it->second;
+        for(unsigned int i = 0; i < group.size(); i += Ensemble::MaxInstances)
+        {
+            vector<EnsembleMember*> pack(group.begin() + i, group.begin() + min<size_t>(group.size(), i + Ensemble::MaxInstances));
+            pool.add([pack]() { runEnsemble(pack); });
+        }
+    }
+    pool.wait();
+
+    int failed = 0;
+    for(unsigned int i = 0; i < members.size(); i++)
+    {
+        EnsembleMember &member = members[i];
+        if(!member.error.empty())
+        {
+            cerr << "line " << member.lineNumber << ": " << member.error;
+            if(member.error[member.error.length() - 1] != '\n') cerr << "\n";
+        }
+        if(member.status != 0) failed++;
+        *jsonl << "{\"line\": " << member.lineNumber << ", \"args\": \"" << escapeJSON(member.line) << "\", \"status\": " << member.status
+               << ", \"population\": " << member.population << ", \"extinct\": " << member.extinct << ", \"error\": \"" << escapeJSON(member.error) << "\"}\n";
+    }
+    jsonl->flush();
+    if(failed > 0)
+    {
+        cerr << failed << " of " << members.size() << " worlds failed\n";
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2 || flagPos(argc, argv, "-h") != -1)
+    {
+        cout << "\nUsage: lifebatch manifest [-j n] [-o dir] [-jsonl file]\n";
+        cout << "       lifebatch -sweep file [-rules l..h] [-g n] [-j n] [-jsonl file] [life switches]\n";
+        cout << "       lifebatch -ensemble manifest [-j n] [-jsonl file]\n\n";
+        cout << "lifebatch runs a life job for each line of the manifest at the same time on a pool of threads.\n";
+        cout << "Each manifest line is an automaton file followed by any life switches, for example: glider.life -g 10 -tx 0..20 -f\n";
+        cout << "Empty lines and lines starting with # are skipped. The output of each job is exactly what life prints for the same switches.\n\n";
+        cout << "Supported switches:\n";
+        cout << "-h displays the help menu.\n";
+        cout << "-j n number of jobs run at the same time. The number of hardware threads by default.\n";
+        cout << "-o dir writes the output of each job to dir/line.out, where line is the line of the job in the manifest.\n";
+        cout << "-jsonl file writes one JSON object per job with its line, arguments, status, output and errors to file in manifest order.\n";
+        cout << "If neither -o nor -jsonl is given, the JSONL is written to standard out.\n\n";
+        cout << "-sweep file reads and parses a Life-like or Elementary file once and simulates it under each rule in the range on the pool of threads.\n";
+        cout << "-rules l..h range of rules to sweep, 0..255 for Elementary or 0..262143 for Life-like (bits 0-8 born, bits 9-17 stay alive). All rules by default.\n";
+        cout << "-g n most generations simulated for each rule. 1000 by default.\n";
+        cout << "Each rule is simulated until it dies, becomes static or repeats an earlier generation and one JSON line per rule gives its final population, period (0 if none was found) and the generation it stabilised at (-1 if it did not).\n\n";
+        cout << "-ensemble manifest simulates the Life-like world of each manifest line, 64 at a time in one pass for lines with the same rule, terrain size and -g.\n";
+        cout << "One JSON line per manifest line gives its final population and the generation it died out in (-1 if it did not).\n";
+        return 0;
+    }
+
+    if(flagPos(argc, argv, "-sweep") != -1)
+    {
+        if(flagPos(argc, argv, "-sweep") + 1 >= argc)
+        {
+            cerr << "-sweep needs an automaton file\n";
+            return -1;
+        }
+        return sweep(argc, argv);
+    }
+
+    if(flagPos(argc, argv, "-ensemble") != -1)
+    {
+        if(flagPos(argc, argv, "-ensemble") + 1 >= argc)
+        {
+            cerr << "-ensemble needs a manifest\n";
+            return -1;
+        }
+        return ensembles(argc, argv);
+    }
+
+    ifstream manifest(argv[1]);
+    if(!manifest.is_open())
+    {
+        cerr << "problem reading from file: " << argv[1] << "\n";
+        return -1;
+    }
+    vector<BatchJob> jobs;
+    readManifest(manifest, jobs);
+    manifest.close();
+
+    BatchOutput output;
+    output.dir = flagValue(argc, argv, "-o");
+    output.jsonl = NULL;
+    output.jobs = &jobs;
+    output.nextJob = 0;
+
+    ofstream jsonlFile;
+    string jsonlName = flagValue(argc, argv, "-jsonl");
+    if(!jsonlName.empty())
+    {
+        jsonlFile.open(jsonlName);
+        if(!jsonlFile.is_open())
+        {
+            cerr << "problem writing to file: " << jsonlName << "\n";
+            return -1;
+        }
+        output.jsonl = &jsonlFile;
+    }
+    else if(output.dir.empty())
+    {
+        output.jsonl = &cout;
+    }
+
+    string threads = flagValue(argc, argv, "-j");
+    {
+        ThreadPool pool(threads.empty() ? 0 : atoi(threads.c_str()));
+        for(unsigned int i = 0; i < jobs.size(); i++)
+        {
+            BatchJob *job = &jobs[i];
+            pool.add([&output, job]()
+            {
+                runJob(*job);
+                writeResult(output, *job);
+            });
+        }
+        pool.wait();
+    }
+
+    int failed = 0;
+    for(unsigned int i = 0; i < jobs.size(); i++)
+    {
+        if(jobs[i].status != 0) failed++;
+    }
+    if(failed > 0)
+    {
+        cerr << failed << " of " << jobs.size() << " jobs failed\n";
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,452 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdlib.h>
+#include "string.h"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "lifeclass.h"
+#include "elementary.h"
+#include "brian.h"
+#include "world.h"
+
+/**
+ * lifebench program that measures how fast worlds of each automaton can be simulated
+ * without parsing or printing getting in the way.
+ * @author Alex Cole
+ */
+
+/**
+ * Result of benchmarking one automaton, size and pattern.
+ */
+struct BenchResult
+{
+    string automaton;
+    string pattern;
+    int size;
+    double density;
+    int generations;
+    int simulatedGenerations;
+    int blockDepth;
+    int reps;
+    double meanSeconds;
+    double bestSeconds;
+    long peakRSS;
+};
+
+/**
+ * Gets the position of a flag.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ * @param flag
+ *          The flag to get the position of.
+ * @return
+ *          The position of the last occurrence of the flag otherwise -1.
+ */
+int flagPos(int argc, char *argv[], const char *flag)
+{
+    int pos = -1;
+    for(int i = 1; i < argc; i++)
+    {
+        if(0 == strcmp(argv[i], flag)) pos = i;
+    }
+    return pos;
+}
+
+/**
+ * Gets the value given after a flag.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ * @param flag
+ *          The flag to get the value of.
+ * @param defaultValue
+ *          The value returned if the flag was not given.
+ * @return
+ *          The value after the flag otherwise the default value.
+ */
+string flagValue(int argc, char *argv[], const char *flag, string defaultValue)
+{
+    int pos = flagPos(argc, argv, flag);
+    return pos != -1 && pos + 1 < argc ? argv[pos + 1] : defaultValue;
+}
+
+/**
+ * Splits a comma separated list.
+ * @param list
+ *          The comma separated list.
+ * @return
+ *          The items in the list.
+ */
+vector<string> splitList(string list)
+{
+    vector<string> ret;
+    stringstream in(list);
+    string item;
+    while(getline(in, item, ','))
+    {
+        if(!item.empty()) ret.push_back(item);
+    }
+    return ret;
+}
+
+/**
+ * Gets the cells of a canonical pattern with (0, 0) as the top left corner and y going down.
+ * @param pattern
+ *          The name of the pattern: rpentomino, acorn or gosper.
+ * @return
+ *          The (x, y) offsets of the cells in the pattern, empty if the pattern is unknown.
+ */
+vector<pair<int, int>> patternCells(string pattern)
+{
+    static const int rpentomino[][2] = { {1,0},{2,0},{0,1},{1,1},{1,2} };
+    static const int acorn[][2] = { {1,0},{3,1},{0,2},{1,2},{4,2},{5,2},{6,2} };
+    static const int gosper[][2] = { {24,0},{22,1},{24,1},{12,2},{13,2},{20,2},{21,2},{34,2},{35,2},{11,3},{15,3},{20,3},
+        {21,3},{34,3},{35,3},{0,4},{1,4},{10,4},{16,4},{20,4},{21,4},{0,5},{1,5},{10,5},{14,5},{16,5},{17,5},{22,5},
+        {24,5},{10,6},{16,6},{24,6},{11,7},{15,7},{12,8},{13,8} };
+
+    vector<pair<int, int>> ret;
+    if(pattern == "rpentomino")
+    {
+        for(unsigned int i = 0; i < sizeof(rpentomino) / sizeof(rpentomino[0]); i++) ret.push_back(make_pair(rpentomino[i][0], rpentomino[i][1]));
+    }
+    else if(pattern == "acorn")
+    {
+        for(unsigned int i = 0; i < sizeof(acorn) / sizeof(acorn[0]); i++) ret.push_back(make_pair(acorn[i][0], acorn[i][1]));
+    }
+    else if(pattern == "gosper")
+    {
+        for(unsigned int i = 0; i < sizeof(gosper) / sizeof(gosper[0]); i++) ret.push_back(make_pair(gosper[i][0], gosper[i][1]));
+    }
+    return ret;
+}
+
+/**
+ * Creates an automaton with a size by size terrain and no initial cells.
+ * @param type
+ *          The automaton: life, elementary or brian.
+ * @param size
+ *          The width and height of the terrain.
+ * @return
+ *          The automaton or NULL if the type is unknown.
+ */
+CellularAutomaton* createAutomaton(string type, int size)
+{
+    ostringstream terrain;
+    terrain << "Terrain={Xrange=0.." << size - 1 << ";Yrange=0.." << size - 1 << ";};";
+    if(type == "life")
+    {
+        return new Life("{Rule=B3/S23;" + terrain.str() + "Chars={Alive=64;Dead=46;};Colors={Alive=(255,255,255);Dead=(0,0,0);};Initial={Alive=;};}");
+    }
+    else if(type == "elementary")
+    {
+        return new Elementary("{Rule=30;" + terrain.str() + "Chars={One=64;Zero=46;};Colors={One=(255,255,255);Zero=(0,0,0);};Initial={One=;};}");
+    }
+    else if(type == "brian")
+    {
+        return new Brian("{" + terrain.str() + "Chars={Ready=46;Firing=64;Refactory=43;};Colors={Ready=(0,0,0);Firing=(255,255,255);Refactory=(0,0,255);};Initial={Ready=;Firing=;};}");
+    }
+    return NULL;
+}
+
+/**
+ * Adds the initial cells for a pattern to an automaton. A soup fills the whole terrain at random with
+ * the given density (only the top row for elementary), any other pattern is placed in the center.
+ * @param automaton
+ *          The automaton to add the cells to.
+ * @param type
+ *          The automaton: life, elementary or brian.
+ * @param pattern
+ *          The pattern: soup, rpentomino, acorn or gosper.
+ * @param size
+ *          The width and height of the terrain.
+ * @param density
+ *          The chance of a cell being set in a soup.
+ * @param seed
+ *          The seed for the soup.
+ * @return
+ *          True if the pattern is known otherwise false.
+ */
+bool addPattern(CellularAutomaton *automaton, string type, string pattern, int size, double density, unsigned int seed)
+{
+    State state = type == "life" ? State::ALIVE : (type == "elementary" ? State::ONE : State::FIRING);
+    Initial *initial = automaton->getInitial();
+    if(pattern == "soup")
+    {
+        mt19937 random(seed);
+        uniform_real_distribution<double> chance(0.0, 1.0);
+        int soupRows = type == "elementary" ? 1 : size;
+        for(int y = size - 1; y > size - 1 - soupRows; y--)
+        {
+            for(int x = 0; x < size; x++)
+            {
+                if(chance(random) < density) initial->addCell(Cell(x, y, state));
+            }
+        }
+        return true;
+    }
+
+    vector<pair<int, int>> cells = patternCells(pattern);
+    for(unsigned int i = 0; i < cells.size(); i++) //y goes down in the pattern but up in the terrain
+    {
+        initial->addCell(Cell((size / 2 + cells[i].first) % size, (size / 2 - cells[i].second + size) % size, state));
+    }
+    return !cells.empty();
+}
+
+/**
+ * Gets the peak resident set size of the process. Each configuration is benchmarked in its own child
+ * process, so this is the peak of that configuration alone.
+ * @return
+ *          The peak resident set size in kilobytes.
+ */
+long peakRSS()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Benchmarks one automaton, size and pattern. The world is reset before each repetition so every
+ * repetition simulates the same generations. Warmup repetitions are not timed. A world that stops
+ * changing stops being simulated, so fewer generations than were asked for may be simulated.
+ * @param result
+ *          The result to fill in. automaton, pattern, size, density, generations, blockDepth and reps must be set.
+ * @param warmup
+ *          The number of untimed repetitions.
+ * @param seed
+ *          The seed for soups.
+ * @return
+ *          True if the benchmark was run otherwise false.
+ */
+bool bench(BenchResult &result, int warmup, unsigned int seed)
+{
+    CellularAutomaton *automaton = createAutomaton(result.automaton, result.size);
+    if(automaton == NULL)
+    {
+        cerr << "Unknown automaton: " << result.automaton << endl;
+        return false;
+    }
+    if(!addPattern(automaton, result.automaton, result.pattern, result.size, result.density, seed))
+    {
+        cerr << "Unknown pattern: " << result.pattern << endl;
+        delete automaton;
+        return false;
+    }
+
+    World *world = new World(automaton);
+    world->setBlockDepth(result.blockDepth);
+    for(int i = 0; i < warmup; i++)
+    {
+        world->simulate(result.generations);
+        world->reset();
+    }
+
+    double total = 0;
+    result.bestSeconds = -1;
+    for(int i = 0; i < result.reps; i++)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        world->simulate(result.generations);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        total += seconds;
+        if(result.bestSeconds < 0 || seconds < result.bestSeconds) result.bestSeconds = seconds;
+        result.simulatedGenerations = world->getGeneration();
+        world->reset();
+    }
+    result.meanSeconds = result.reps > 0 ? total / result.reps : 0;
+    result.peakRSS = peakRSS();
+
+    delete world;
+    delete automaton;
+    return true;
+}
+
+/**
+ * Benchmarks one automaton, size and pattern in a child process, so its peak resident set size is not
+ * raised by the configurations benchmarked before it.
+ * @param result
+ *          The result to fill in. automaton, pattern, size, density, generations, blockDepth and reps must be set.
+ * @param warmup
+ *          The number of untimed repetitions.
+ * @param seed
+ *          The seed for soups.
+ * @return
+ *          True if the benchmark was run otherwise false.
+ */
+bool benchInChild(BenchResult &result, int warmup, unsigned int seed)
+{
+    int fds[2];
+    if(pipe(fds) != 0)
+    {
+        cerr << "Could not create pipe" << endl;
+        return false;
+    }
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        cerr << "Could not fork" << endl;
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if(pid == 0)
+    {
+        close(fds[0]);
+        bool ran = false;
+        try
+        {
+            ran = bench(result, warmup, seed);
+        }
+        catch(int e)
+        {
+        }
+        ostringstream measured;
+        measured.precision(17);
+        measured << result.simulatedGenerations << " " << result.meanSeconds << " " << result.bestSeconds << " " << result.peakRSS;
+        string text = measured.str();
+        bool sent = ran && write(fds[1], text.c_str(), text.size()) == (ssize_t) text.size();
+        close(fds[1]);
+        _exit(sent ? 0 : 1);
+    }
+
+    close(fds[1]);
+    string text;
+    char buffer[256];
+    ssize_t count;
+    while((count = read(fds[0], buffer, sizeof(buffer))) > 0) text.append(buffer, count);
+    close(fds[0]);
+    int status;
+    if(waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return false;
+
+    istringstream measured(text);
+    measured >> result.simulatedGenerations >> result.meanSeconds >> result.bestSeconds >> result.peakRSS;
+    return !measured.fail();
+}
+
+/**
+ * Prints the results in JSON format.
+ * @param results
+ *          The benchmark results.
+ */
+void printJSON(vector<BenchResult> &results)
+{
+    cout << "[\n";
+    for(unsigned int i = 0; i < results.size(); i++)
+    {
+        BenchResult &r = results[i];
+        double cells = (double) r.size * r.size;
+        double gensPerSec = r.meanSeconds > 0 ? r.simulatedGenerations / r.meanSeconds : 0;
+        cout << "  {\"automaton\": \"" << r.automaton << "\", \"pattern\": \"" << r.pattern << "\", \"size\": " << r.size
+             << ", \"density\": " << r.density << ", \"generations\": " << r.generations
+             << ", \"simulated_generations\": " << r.simulatedGenerations << ", \"block\": " << r.blockDepth << ", \"reps\": " << r.reps
+             << ", \"mean_seconds\": " << r.meanSeconds << ", \"best_seconds\": " << r.bestSeconds
+             << ", \"generations_per_sec\": " << gensPerSec << ", \"cell_updates_per_sec\": " << gensPerSec * cells
+             << ", \"peak_rss_kb\": " << r.peakRSS << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    cout << "]" << endl;
+}
+
+/**
+ * Prints the results as a table.
+ * @param results
+ *          The benchmark results.
+ */
+void printTable(vector<BenchResult> &results)
+{
+    cout << "automaton   pattern     size   gens  sim   block mean(s)     best(s)     gens/s      cell-updates/s  peak-rss(kB)\n";
+    for(unsigned int i = 0; i < results.size(); i++)
+    {
+        BenchResult &r = results[i];
+        double cells = (double) r.size * r.size;
+        double gensPerSec = r.meanSeconds > 0 ? r.simulatedGenerations / r.meanSeconds : 0;
+        char line[256];
+        snprintf(line, sizeof(line), "%-11s %-11s %-6d %-5d %-5d %-5d %-11.6f %-11.6f %-11.2f %-15.4g %ld\n", r.automaton.c_str(), r.pattern.c_str(),
+                 r.size, r.generations, r.simulatedGenerations, r.blockDepth, r.meanSeconds, r.bestSeconds, gensPerSec, gensPerSec * cells, r.peakRSS);
+        cout << line;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if(flagPos(argc, argv, "-h") != -1)
+    {
+        cout << "\nlifebench measures how fast worlds can be simulated, without parsing or printing.\n\n";
+        cout << "Supported switches:\n";
+        cout << "-h displays the help menu.\n";
+        cout << "-a list comma separated automata to run: life, elementary, brian. All three by default.\n";
+        cout << "-n list comma separated terrain sizes, each world is size by size. 256 by default.\n";
+        cout << "-p list comma separated patterns: soup, rpentomino, acorn, gosper. soup by default.\n";
+        cout << "-d density chance of a cell being set in a soup. 0.5 by default.\n";
+        cout << "-g n generations simulated per repetition. 100 by default.\n";
+        cout << "-block list comma separated numbers of generations simulated at a time on each cache sized tile. 1 (no tiles) by default.\n";
+        cout << "-r n timed repetitions. 3 by default.\n";
+        cout << "-w n untimed warmup repetitions. 1 by default.\n";
+        cout << "-seed n seed for soups. 1 by default.\n";
+        cout << "-json prints the results in JSON format.\n";
+        cout << "\nA world that stops changing stops being simulated, so gens/s and cell-updates/s are based on the\n";
+        cout << "generations actually simulated (sim). Each configuration runs in its own process, so peak-rss is its own peak.\n";
+        return 0;
+    }
+
+    vector<string> automata = splitList(flagValue(argc, argv, "-a", "life,elementary,brian"));
+    vector<string> sizes = splitList(flagValue(argc, argv, "-n", "256"));
+    vector<string> patterns = splitList(flagValue(argc, argv, "-p", "soup"));
+    double density = atof(flagValue(argc, argv, "-d", "0.5").c_str());
+    int generations = atoi(flagValue(argc, argv, "-g", "100").c_str());
+    vector<string> depths = splitList(flagValue(argc, argv, "-block", "1"));
+    int reps = atoi(flagValue(argc, argv, "-r", "3").c_str());
+    int warmup = atoi(flagValue(argc, argv, "-w", "1").c_str());
+    unsigned int seed = atoi(flagValue(argc, argv, "-seed", "1").c_str());
+    if(generations < 0 || reps < 1 || warmup < 0)
+    {
+        cerr << "Generations and warmup cannot be less than 0 and repetitions cannot be less than 1" << endl;
+        return -1;
+    }
+
+    vector<BenchResult> results;
+    for(unsigned int a = 0; a < automata.size(); a++)
+    {
+        for(unsigned int s = 0; s < sizes.size(); s++)
+        {
+            for(unsigned int p = 0; p < patterns.size(); p++)
+            {
+                for(unsigned int b = 0; b < depths.size(); b++)
+                {
+                    BenchResult result;
+                    result.automaton = automata[a];
+                    result.pattern = patterns[p];
+                    result.size = atoi(sizes[s].c_str());
+                    result.density = density;
+                    result.generations = generations;
+                    result.blockDepth = atoi(depths[b].c_str());
+                    result.reps = reps;
+                    if(result.size < 1)
+                    {
+                        cerr << "Invalid size: " << sizes[s] << endl;
+                        return -1;
+                    }
+                    if(!benchInChild(result, warmup, seed)) return -1;
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+
+    if(flagPos(argc, argv, "-json") != -1)
+    {
+        printJSON(results);
+    }
+    else
+    {
+        printTable(results);
+    }
+    return 0;
+}
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <fstream>
 #include "settings.h"
 #include "lifeclass.h"
 #include "elementary.h"
@@ -55,7 +54,9 @@ int main(int argc, char* argv[])
         cout << "simulation delay will be updated as the simulation continues. Once the simulation has been started, it stopped by pressing Restart, Quit\n";
         cout << "or Step. The simulation simulates one generation at a time.\n";
         cout << "-Step    - This will simulate one generation and then update the GuiWidget. If the simulation was started, this will stop it but will not alter the\n";
-        cout << "delay or grid size.\n\n";
+        cout << "delay or grid size.\n";
+        cout << "-Cancel  - Shown while the simulation is catching up to the generation given by -g. This stops catching up and leaves the\n";
+        cout << "simulation at the last generation that was reached.\n\n";
         cout << "-Grid size box and slider adjusts the size of the grid squares in pixels\n";
         cout << "-Delay box and slider adjusts the delay between generations in simulation\n";
         return 0;
@@ -71,13 +72,11 @@ int main(int argc, char* argv[])
     }
     else
     {
-        ifstream in(settings.getInFile());
-        if(settings.stripWhitespaceAndComments(in) != 0)
+        if(settings.readFile(settings.getInFile()) != 0)
         {
             cerr << "problem reading from file: " << settings.getInFile() << "\n";
             return -1;
         }
-        in.close();
     }
 
     CellularAutomaton *automaton = NULL;
@@ -85,17 +84,18 @@ int main(int argc, char* argv[])
     try
     {
         map<string, string> automatonStruct = AutomatonParser::parse(settings.getInput());
+        settings.clearInput();
         if(!automatonStruct["Life"].empty())
         {
-            automaton = new Life(automatonStruct["Life"]);
+            automaton = new Life(AutomatonParser::takeValue(automatonStruct, "Life"));
         }
         else if(!automatonStruct["Elementary"].empty())
         {
-            automaton = new Elementary(automatonStruct["Elementary"]);
+            automaton = new Elementary(AutomatonParser::takeValue(automatonStruct, "Elementary"));
         }
         else if(!automatonStruct["Brian"].empty())
         {
-            automaton = new Brian(automatonStruct["Brian"]);
+            automaton = new Brian(AutomatonParser::takeValue(automatonStruct, "Brian"));
         }
         else
         {
@@ -104,8 +104,7 @@ int main(int argc, char* argv[])
         }
         automaton->updateTerrain(settings.getTX(), settings.getTY());
         automaton->updateWindow(settings.getWX(), settings.getWY());
-        world = new World(automaton);
-        world->simulate(settings.getGenerations());
+        world = new World(automaton); //generations are simulated by the control so the window shows right away
     }
     catch(int e)
     {
@@ -0,0 +1,192 @@
+#include "lifejob.h"
+#include "lifeclass.h"
+#include "elementary.h"
+#include "brian.h"
+#include "world.h"
+#include "automatonparser.h"
+#include "stats.h"
+
+/**
+ * Implementation of lifejob.h
+ * @author Alex Cole
+ */
+
+/**
+ * Constructor that takes in the settings for the job.
+ * @param settings
+ *          The settings for the job. Input is read from standard in if no file is given.
+ */
+LifeJob::LifeJob(const Settings &settings)
+    : settings(settings) {}
+
+/**
+ * Destructor
+ */
+LifeJob::~LifeJob() {}
+
+/**
+ * Runs the job, writing the world in the format given by the settings to out, exactly as life
+ * prints it, and writing stats if -stats was given.
+ * @param out
+ *          The stream the world is printed to.
+ * @param err
+ *          The stream problems with the job are reported to.
+ * @return
+ *          0 if the job was successful otherwise -1.
+ */
+int LifeJob::run(ostream &out, ostream &err)
+{
+    Stats *stats = settings.getStatsFile().empty() ? NULL : new Stats();
+    if(stats != NULL && settings.perfFlag() && !stats->enableCounters())
+    {
+        err << "hardware counters are unavailable, stats will not include them\n";
+    }
+    Stats::Clock::time_point start;
+    if(stats != NULL) start = Stats::now();
+
+    CellularAutomaton *automaton = NULL;
+    World *world = NULL;
+    try
+    {
+        automaton = createAutomaton(err);
+        if(automaton == NULL)
+        {
+            delete stats;
+            return -1;
+        }
+        if(stats != NULL)
+        {
+            stats->addPhase("parse", start);
+            start = Stats::now();
+        }
+
+        world = new World(automaton);
+        world->setBlockDepth(settings.getBlockDepth());
+        if(stats != NULL)
+        {
+            stats->addPhase("world construction", start);
+            world->setStats(stats);
+        }
+        world->simulate(settings.getGenerations());
+    }
+    catch(int e)
+    {
+        if(e == InvalidFileFormatException)
+        {
+            err << "File is not in valid life file format: " << settings.getInFile() << endl;
+        }
+        delete automaton;
+        delete world;
+        delete stats;
+        return -1;
+    }
+
+    //the world cells are converted to terrain cells before rendering starts, since they are recorded as their own phase
+    CellularAutomaton *updated = settings.fileFormat() ? world->getAutomaton() : NULL;
+    if(stats != NULL)
+    {
+        start = Stats::now();
+        stats->startCounters();
+    }
+    if(settings.fileFormat())
+    {
+        out << updated->toString(); //-f
+    }
+    else
+    {
+        out << world->toString(); //-v or if no flag specified
+    }
+    out << endl;
+
+    int ret = 0;
+    if(stats != NULL)
+    {
+        stats->addPhase("rendering", start);
+        if(stats->write(settings.getStatsFile()) != 0)
+        {
+            err << "problem writing stats to file: " << settings.getStatsFile() << "\n";
+            ret = -1;
+        }
+    }
+
+    delete automaton;
+    delete world;
+    delete stats;
+    return ret;
+}
+
+/**
+ * Reads and parses the automaton file and applies the terrain and window ranges from the settings.
+ * @param err
+ *          The stream problems with the file are reported to.
+ * @return
+ *          The automaton, which must be deleted by the caller, or NULL if the file could not be read
+ *          or does not contain a cellular automaton.
+ * @throws InvalidFileFormatException
+ *          If the file is not in valid life file format.
+ */
+CellularAutomaton* LifeJob::createAutomaton(ostream &err)
+{
+    if(readInput(err) != 0) return NULL;
+
+    CellularAutomaton *automaton = NULL;
+    map<string, string> automatonStruct = AutomatonParser::parse(settings.getInput());
+    settings.clearInput();
+    if(!automatonStruct["Life"].empty())
+    {
+        automaton = new Life(AutomatonParser::takeValue(automatonStruct, "Life"));
+    }
+    else if(!automatonStruct["Elementary"].empty())
+    {
+        automaton = new Elementary(AutomatonParser::takeValue(automatonStruct, "Elementary"));
+    }
+    else if(!automatonStruct["Brian"].empty())
+    {
+        automaton = new Brian(AutomatonParser::takeValue(automatonStruct, "Brian"));
+    }
+    else
+    {
+        err << "File does not contain valid cellular automaton: " << settings.getInFile() << endl;
+        return NULL;
+    }
+
+    try
+    {
+        automaton->updateTerrain(settings.getTX(), settings.getTY());
+        automaton->updateWindow(settings.getWX(), settings.getWY());
+    }
+    catch(int e)
+    {
+        delete automaton;
+        throw;
+    }
+    return automaton;
+}
+
+/**
+ * Reads the automaton file or standard in if no file was given.
+ * @param err
+ *          The stream problems are reported to.
+ * @return
+ *          0 if the input was read successfully otherwise -1.
+ */
+int LifeJob::readInput(ostream &err)
+{
+    if(settings.getInFile().empty()) //no file specified, then read from cin
+    {
+        if(settings.stripWhitespaceAndComments(cin) != 0)
+        {
+            err << "problem reading from standard input\n";
+            return -1;
+        }
+    }
+    else
+    {
+        if(settings.readFile(settings.getInFile()) != 0)
+        {
+            err << "problem reading from file: " << settings.getInFile() << "\n";
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "perfcounters.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/**
+ * Implementation of perfcounters.h
+ * @author Alex Cole
+ */
+
+/**
+ * Default constructor that opens the counter group.
+ */
+PerfCounters::PerfCounters()
+{
+    static const unsigned long long events[NumCounters] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+    for(int i = 0; i < NumCounters; i++)
+    {
+        fds[i] = -1;
+    }
+    for(int i = 0; i < NumCounters; i++)
+    {
+        fds[i] = openCounter(events[i], fds[0]);
+        if(fds[i] == -1) //a partial group would give misleading numbers, so give up on all of them
+        {
+            close();
+            return;
+        }
+    }
+}
+
+/**
+ * Destructor that closes the counter group.
+ */
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+/**
+ * Checks if the counters could be opened.
+ * @return
+ *          True if the counters are available otherwise false.
+ */
+bool PerfCounters::isAvailable()
+{
+    return fds[0] != -1;
+}
+
+/**
+ * Resets the counters and starts counting.
+ */
+void PerfCounters::start()
+{
+    if(!isAvailable()) return;
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+/**
+ * Stops counting and reads the counters.
+ * @param sample
+ *          The sample the counter values are read into.
+ * @return
+ *          True if the counters were read otherwise false.
+ */
+bool PerfCounters::stop(PerfSample &sample)
+{
+    if(!isAvailable()) return false;
+    ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    unsigned long long values[1 + NumCounters]; //number of counters followed by each value
+    if(read(fds[0], values, sizeof(values)) != (ssize_t) sizeof(values) || values[0] != NumCounters) return false;
+
+    sample.cycles = values[1];
+    sample.instructions = values[2];
+    sample.cacheMisses = values[3];
+    sample.branchMisses = values[4];
+    return true;
+}
+
+/**
+ * Opens one hardware counter.
+ * @param config
+ *          The hardware event to count.
+ * @param groupFd
+ *          The file descriptor of the group leader or -1 to open the leader.
+ * @return
+ *          The file descriptor of the counter or -1 if it could not be opened.
+ */
+int PerfCounters::openCounter(unsigned long long config, int groupFd)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = groupFd == -1 ? 1 : 0; //only the leader is disabled, the group follows it
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+/**
+ * Closes all the counters that are open.
+ */
+void PerfCounters::close()
+{
+    for(int i = NumCounters - 1; i >= 0; i--)
+    {
+        if(fds[i] != -1) ::close(fds[i]);
+        fds[i] = -1;
+    }
+}
@@ -0,0 +1,117 @@
+#include "rulesweep.h"
+#include <map>
+#include <sstream>
+#include <iostream>
+#include "lifeclass.h"
+#include "elementary.h"
+#include "world.h"
+
+/**
+ * Implementation of rulesweep.h
+ * @author Alex Cole
+ */
+
+/**
+ * Constructor that takes in the automaton to sweep.
+ * @param automaton
+ *          The Life-like or Elementary automaton that gives the terrain and initial cells.
+ * @param maxGenerations
+ *          The most generations simulated for a rule.
+ * @throws InvalidRuleException
+ *          If the automaton is not Life-like or Elementary.
+ */
+RuleSweep::RuleSweep(RuleAutomaton *automaton, int maxGenerations)
+{
+    this->automaton = automaton;
+    this->maxGenerations = maxGenerations;
+    if(dynamic_cast<Life*>(automaton) != NULL)
+    {
+        life = true;
+    }
+    else if(dynamic_cast<Elementary*>(automaton) != NULL)
+    {
+        life = false;
+    }
+    else
+    {
+        cerr << "Rules can only be swept for Life-like and Elementary automata" << endl;
+        throw InvalidRuleException;
+    }
+}
+
+/**
+ * Destructor that does not delete the automaton.
+ */
+RuleSweep::~RuleSweep() {}
+
+/**
+ * Gets the number of rules for the automaton.
+ * @return
+ *          256 for Elementary or 262144 for Life-like.
+ */
+int RuleSweep::numRules()
+{
+    return life ? 1 << 18 : 256;
+}
+
+/**
+ * Simulates the automaton under a rule until it dies, becomes static, repeats an earlier
+ * generation or reaches the most generations.
+ * @param rule
+ *          The number of the rule.
+ * @return
+ *          The summary of the simulation.
+ */
+RuleSummary RuleSweep::run(int rule)
+{
+    RuleAutomaton *copy = NULL;
+    if(life)
+    {
+        Life *lifeCopy = new Life(*((Life*) automaton));
+        lifeCopy->setRuleMasks(rule & 0x1FF, rule >> 9);
+        copy = lifeCopy;
+    }
+    else
+    {
+        ostringstream ruleStr;
+        ruleStr << rule;
+        copy = new Elementary(*((Elementary*) automaton));
+        copy->setRule(ruleStr.str());
+    }
+
+    RuleSummary summary;
+    summary.rule = rule;
+    summary.ruleStr = copy->getRule();
+    summary.period = 0;
+    summary.stabilised = -1;
+
+    World *world = new World(copy);
+    map<unsigned long long, int> seen; //generation each state of the world was first seen
+    seen[world->getHash()] = 0;
+    int generation = 0;
+    while(generation < maxGenerations)
+    {
+        if(!world->step()) //nothing changed, so the last generation is the same as this one
+        {
+            summary.period = 1;
+            summary.stabilised = generation;
+            break;
+        }
+        generation++;
+
+        map<unsigned long long, int>::iterator found = seen.find(world->getHash());
+        if(found != seen.end())
+        {
+            summary.period = generation - found->second;
+            summary.stabilised = found->second;
+            break;
+        }
+        seen[world->getHash()] = generation;
+    }
+    summary.population = world->getPopulation();
+    summary.generations = generation;
+
+    delete world;
+    delete copy;
+    return summary;
+}
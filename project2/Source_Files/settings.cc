@@ -1,8 +1,13 @@
 #include "settings.h"
+#include "automatonparser.h"
 #include <stdlib.h>
 #include "string.h"
 #include <iostream>
 #include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /**
 * @author Alex Cole
@@ -17,12 +22,15 @@ Settings::Settings()
     help = false;
     textOutput = false;
     control = false;
+    perf = false;
     generations = 0;
+    blockDepth = 1;
     gridSize = 10;
     tx = "";
     ty = "";
     wx = "";
     wy = "";
+    statsFile = "";
     inFile = "";
     input = "";
 }
@@ -54,10 +62,13 @@ Settings::~Settings() {}
 void Settings::init(int argc, char *argv[])
 {
     setFile(argc, argv);
+    setStats(argc, argv);
+    setPerf(argc, argv);
     setHelp(argc, argv);
     setControl(argc, argv);
     setOutput(argc, argv);
     setGenerations(argc, argv);
+    setBlockDepth(argc, argv);
     setGridSize(argc, argv);
     tx = setRange(argc, argv, "-tx");
     ty = setRange(argc, argv, "-ty");
@@ -85,6 +96,16 @@ bool Settings::controlFlag()
     return control;
 }
 
+/**
+ * Gets the hardware counter flag setting.
+ * @return
+ *          True if set otherwise false.
+ */
+bool Settings::perfFlag()
+{
+    return perf;
+}
+
 /**
  * Gets the file format setting.
  * @return
@@ -105,6 +126,16 @@ int Settings::getGenerations()
     return generations;
 }
 
+/**
+ * Gets the number of generations simulated at a time on each tile of the world.
+ * @return
+ *          1 by default otherwise the number -block was set to.
+ */
+int Settings::getBlockDepth()
+{
+    return blockDepth;
+}
+
 /**
  * Gets the grid size.
  * @return
@@ -155,6 +186,15 @@ string Settings::getWY()
     return wy;
 }
 
+/**
+ * Gets the name of the file stats are written to.
+ * @return
+ *          The name of the stats file or an empty string if -stats was not given.
+ */
+string Settings::getStatsFile()
+{
+    return statsFile;
+}
 
 /**
  * Gets the name of the file.
@@ -171,11 +211,74 @@ string Settings::getInFile()
  * @return
  *          The contents of the file.
  */
-string Settings::getInput()
+const string& Settings::getInput()
 {
     return input;
 }
 
+/**
+ * Frees the content of the file once it has been parsed.
+ */
+void Settings::clearInput()
+{
+    string().swap(input);
+}
+
+/**
+ * Reads a file and removes whitespace and comments from it. A regular file is mapped into memory
+ * and read in place so the only copy made is the stripped contents. Anything that can not be
+ * mapped, such as a pipe, is read as a stream instead.
+ * @param fileName
+ *          The name of the file to read.
+ * @return
+ *          0 if file read successfully otherwise -1.
+ */
+int Settings::readFile(string fileName)
+{
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) { return -1; }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+    {
+        close(fd);
+        ifstream in(fileName);
+        return stripWhitespaceAndComments(in);
+    }
+
+    size_t length = info.st_size;
+    void *mapped = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED)
+    {
+        ifstream in(fileName);
+        return stripWhitespaceAndComments(in);
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);
+
+    const char *data = (const char*) mapped;
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t released = 0; //pages before this have been read and given back
+    input.reserve(input.size() + length);
+    size_t pos = 0;
+    while(pos < length)
+    {
+        const char *newline = (const char*) memchr(data + pos, '\n', length - pos);
+        size_t end = newline == NULL ? length : newline - data;
+        stripLine(data + pos, end - pos);
+        pos = end + 1;
+
+        size_t done = pos / pageSize * pageSize;
+        if(done - released >= ReleaseSize) //keeps only the unread part of a large file resident
+        {
+            madvise((char*) mapped + released, done - released, MADV_DONTNEED);
+            released = done;
+        }
+    }
+    munmap(mapped, length);
+    return 0;
+}
+
 /**
  * Removes whitesapce and comments from the contents of the file.
  * @param in
@@ -190,47 +293,8 @@ int Settings::stripWhitespaceAndComments(istream& in)
     string line = "";
     while(!in.eof())
     {
-        unsigned int i = 0;
         getline(in, line);
-        line = trimLeft(line);
-        if(line[0] != '#' && i != line.length()) //removes whitespace and comments unless section is quoted and not in a comment
-        {
-            bool quote = false;
-            while(i < line.length())
-            {
-                if((line[i] == ' ' || line[i] == '\t' || line[i] == '\r') && !quote)
-                {
-                    if ((i + 1) == line.length())
-                    {
-                        line = line.substr(0, i);
-                    }
-                    else
-                    {
-                        line = line.substr(0, i) + line.substr(i + 1, line.length());
-                    }
-                }
-                else if(line[i] == '\"' && !quote)
-                {
-                    quote = true;
-                    i++;
-                }
-                else if(line[i] == '\"' && quote)
-                {
-                    quote = false;
-                    i++;
-                }
-                else if(line[i] == '#' && !quote)
-                {
-                    line = line.substr(0, i);
-                    break;
-                }
-                else
-                {
-                    i++;
-                }
-            }
-            input.append(line);
-        }
+        stripLine(line.data(), line.length());
     }
     return 0;
 }
@@ -246,6 +310,8 @@ void Settings::setFile(int argc, char *argv[])
 {
     for(int i = 1; i < argc; i++)
     {
+        if(0 == strcmp(argv[i - 1], "-stats")) continue; //the stats file is written to, not read from
+
         ifstream in(argv[i]);
         if(in.is_open())
         {
@@ -256,6 +322,38 @@ void Settings::setFile(int argc, char *argv[])
     }
 }
 
+/**
+ * Set the stats file if -stats was given.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ */
+void Settings::setStats(int argc, char *argv[])
+{
+    int pos = flagPos(argc, argv, "-stats");
+    statsFile = pos != -1 && pos + 1 < argc ? argv[pos + 1] : "";
+}
+
+/**
+ * Set the hardware counter value if -perf was given. The counters are written to the stats file,
+ * so -stats must be given as well.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ * @throws InvalidArgumentException
+ */
+void Settings::setPerf(int argc, char *argv[])
+{
+    if(flagPos(argc, argv, "-perf") != -1) perf = true;
+    if(perf && statsFile.empty())
+    {
+        AutomatonParser::errors() << "-perf requires -stats file, which the counters are written to" << endl;
+        throw InvalidArgumentException;
+    }
+}
+
 /**
  * Set the help value if -h was given.
  * @param argc
@@ -309,7 +407,27 @@ void Settings::setGenerations(int argc, char *argv[])
     generations = pos != -1 && pos + 1 < argc ? atoi(argv[pos + 1]) : 0;
     if(generations < 0)
     {
-        cerr << "Generation cannot be a value less than 0: " << generations << endl;
+        AutomatonParser::errors() << "Generation cannot be a value less than 0: " << generations << endl;
+        throw InvalidArgumentException;
+    }
+}
+
+/**
+ * Set the number of generations per tile if -block was given.
+ * @param argc
+ *          The number of arguments.
+ * @param argv
+ *          The array of arguments.
+ * @throws InvalidArgumentException
+ *          If value of the generations per tile is less than 1.
+ */
+void Settings::setBlockDepth(int argc, char *argv[])
+{
+    int pos = flagPos(argc, argv, "-block");
+    blockDepth = pos != -1 && pos + 1 < argc ? atoi(argv[pos + 1]) : 1;
+    if(blockDepth < 1)
+    {
+        AutomatonParser::errors() << "Generations per tile cannot be a value less than 1: " << blockDepth << endl;
         throw InvalidArgumentException;
     }
 }
@@ -329,7 +447,7 @@ void Settings::setGridSize(int argc, char *argv[])
     gridSize = pos != -1 && pos + 1 < argc ? atoi(argv[pos + 1]) : 10;
     if(gridSize < 1)
     {
-        cerr << "Grid size cannot be less than 1: " << gridSize << endl;
+        AutomatonParser::errors() << "Grid size cannot be less than 1: " << gridSize << endl;
         throw InvalidArgumentException;
     }
 }
@@ -376,18 +494,28 @@ int Settings::flagPos(int argc, char *argv[], const char *flag)
 }
 
 /**
- * Removes whitespace from the left of a string.
- * @param str
- *          The string to remove the whitesapce.
- * @return
- *          A string with the whitespace on the left removed.
+ * Removes whitespace and comments from one line of the file and adds the rest to the input.
+ * @param line
+ *          The start of the line.
+ * @param length
+ *          The length of the line, not counting the newline.
  */
-string Settings::trimLeft(string str)
+void Settings::stripLine(const char *line, size_t length)
 {
-    unsigned int i = 0;
-    while(i < str.length() && (str[i] == ' ' || str[i] == '\t' || str[i] == '\r'))
+    size_t i = 0;
+    while(i < length && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'))
     {
         i++;
     }
-    return str.substr(i, str.length());
+    if(i == length || line[i] == '#') return;
+
+    bool quote = false;
+    for(; i < length; i++) //removes whitespace and comments unless section is quoted
+    {
+        char c = line[i];
+        if((c == ' ' || c == '\t' || c == '\r') && !quote) continue;
+        if(c == '#' && !quote) break;
+        if(c == '\"') quote = !quote;
+        input.push_back(c);
+    }
 }
@@ -0,0 +1,238 @@
+#include "stats.h"
+#include <iostream>
+#include <fstream>
+
+/**
+ * Implementation of stats.h
+ * @author Alex Cole
+ */
+
+/**
+ * Default constructor that starts with no phases or generations.
+ */
+Stats::Stats()
+{
+    counters = NULL;
+    counting = false;
+}
+
+/**
+ * Destructor that closes the counters if they were enabled.
+ */
+Stats::~Stats()
+{
+    delete counters;
+}
+
+/**
+ * Opens the hardware counters so they can be started with startCounters.
+ * @return
+ *          True if the counters are available otherwise false, in which case no counters are recorded.
+ */
+bool Stats::enableCounters()
+{
+    if(counters == NULL) counters = new PerfCounters();
+    if(!counters->isAvailable())
+    {
+        delete counters;
+        counters = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Starts the hardware counters if they are enabled. The counters are stopped and recorded with the
+ * next phase or generation that is added.
+ */
+void Stats::startCounters()
+{
+    if(counters == NULL) return;
+    counting = true;
+    counters->start();
+}
+
+/**
+ * Gets the current time to be passed to addPhase or addGeneration later.
+ * @return
+ *          The current time.
+ */
+Stats::Clock::time_point Stats::now()
+{
+    return Clock::now();
+}
+
+/**
+ * Records a phase that started at the given time and ended now.
+ * @param name
+ *          The name of the phase.
+ * @param start
+ *          The time the phase started.
+ */
+void Stats::addPhase(string name, Clock::time_point start)
+{
+    Phase phase;
+    phase.name = name;
+    phase.seconds = secondsSince(start);
+    phase.hasCounters = stopCounters(phase.counters);
+    phases.push_back(phase);
+}
+
+/**
+ * Records a generation that started at the given time and ended now.
+ * @param generation
+ *          The number of the generation that was reached.
+ * @param start
+ *          The time the generation started.
+ * @param changedCells
+ *          The number of cells that changed state in the generation.
+ * @param population
+ *          The number of cells not in the default state after the generation.
+ */
+void Stats::addGeneration(int generation, Clock::time_point start, int changedCells, int population)
+{
+    Generation gen;
+    gen.generation = generation;
+    gen.seconds = secondsSince(start);
+    gen.hasCounters = stopCounters(gen.counters);
+    gen.changedCells = changedCells;
+    gen.population = population;
+    generations.push_back(gen);
+}
+
+/**
+ * Writes the stats to a file. The stats are written as JSON if the file name ends in .json
+ * otherwise they are written as CSV.
+ * @param file
+ *          The name of the file to write to.
+ * @return
+ *          0 if the file was written successfully otherwise -1.
+ */
+int Stats::write(string file)
+{
+    ofstream out(file);
+    if(!out.is_open()) return -1;
+
+    if(file.length() >= 5 && file.compare(file.length() - 5, 5, ".json") == 0)
+    {
+        writeJSON(out);
+    }
+    else
+    {
+        writeCSV(out);
+    }
+    out.close();
+    return out.fail() ? -1 : 0;
+}
+
+/**
+ * Stops the counters if they were started.
+ * @param sample
+ *          The sample the counters are read into.
+ * @return
+ *          True if the counters were read otherwise false.
+ */
+bool Stats::stopCounters(PerfSample &sample)
+{
+    if(!counting) return false;
+    counting = false;
+    return counters->stop(sample);
+}
+
+/**
+ * Writes the counters of a phase or generation as CSV columns, which are empty if there are no counters.
+ * @param out
+ *          The stream to write to.
+ * @param hasCounters
+ *          True if there are counters.
+ * @param sample
+ *          The counters.
+ */
+void Stats::writeCSVCounters(ostream &out, bool hasCounters, PerfSample &sample)
+{
+    if(hasCounters)
+    {
+        double ipc = sample.cycles > 0 ? (double) sample.instructions / sample.cycles : 0;
+        out << "," << sample.cycles << "," << sample.instructions << "," << ipc << "," << sample.cacheMisses << "," << sample.branchMisses << "\n";
+    }
+    else
+    {
+        out << ",,,,,\n";
+    }
+}
+
+/**
+ * Writes the counters of a phase or generation as JSON members, which are left out if there are no counters.
+ * @param out
+ *          The stream to write to.
+ * @param hasCounters
+ *          True if there are counters.
+ * @param sample
+ *          The counters.
+ */
+void Stats::writeJSONCounters(ostream &out, bool hasCounters, PerfSample &sample)
+{
+    if(hasCounters)
+    {
+        double ipc = sample.cycles > 0 ? (double) sample.instructions / sample.cycles : 0;
+        out << ", \"cycles\": " << sample.cycles << ", \"instructions\": " << sample.instructions << ", \"ipc\": " << ipc
+            << ", \"cache_misses\": " << sample.cacheMisses << ", \"branch_misses\": " << sample.branchMisses;
+    }
+    out << "}";
+}
+
+/**
+ * Writes the stats in CSV format.
+ * @param out
+ *          The stream to write to.
+ */
+void Stats::writeCSV(ostream &out)
+{
+    out << "type,name,generation,seconds,changed_cells,population,cycles,instructions,ipc,cache_misses,branch_misses\n";
+    for(unsigned int i = 0; i < phases.size(); i++)
+    {
+        out << "phase," << phases[i].name << ",," << phases[i].seconds << ",,";
+        writeCSVCounters(out, phases[i].hasCounters, phases[i].counters);
+    }
+    for(unsigned int i = 0; i < generations.size(); i++)
+    {
+        out << "generation,," << generations[i].generation << "," << generations[i].seconds << ","
+            << generations[i].changedCells << "," << generations[i].population;
+        writeCSVCounters(out, generations[i].hasCounters, generations[i].counters);
+    }
+}
+
+/**
+ * Writes the stats in JSON format.
+ * @param out
+ *          The stream to write to.
+ */
+void Stats::writeJSON(ostream &out)
+{
+    out << "{\n  \"counters\": " << (counters != NULL ? "true" : "false") << ",\n  \"phases\": [";
+    for(unsigned int i = 0; i < phases.size(); i++)
+    {
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << phases[i].name << "\", \"seconds\": " << phases[i].seconds;
+        writeJSONCounters(out, phases[i].hasCounters, phases[i].counters);
+    }
+    out << "\n  ],\n  \"generations\": [";
+    for(unsigned int i = 0; i < generations.size(); i++)
+    {
+        out << (i == 0 ? "\n" : ",\n") << "    {\"generation\": " << generations[i].generation << ", \"seconds\": " << generations[i].seconds
+            << ", \"changed_cells\": " << generations[i].changedCells << ", \"population\": " << generations[i].population;
+        writeJSONCounters(out, generations[i].hasCounters, generations[i].counters);
+    }
+    out << "\n  ]\n}\n";
+}
+
+/**
+ * Gets the number of seconds from the given time until now.
+ * @param start
+ *          The time to measure from.
+ * @return
+ *          The number of seconds that have passed.
+ */
+double Stats::secondsSince(Clock::time_point start)
+{
+    return chrono::duration<double>(Clock::now() - start).count();
+}
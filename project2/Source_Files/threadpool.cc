@@ -0,0 +1,106 @@
+#include "threadpool.h"
+
+/**
+ * Implementation of threadpool.h
+ * @author Alex Cole
+ */
+
+/**
+ * Constructor that starts the threads.
+ * @param numThreads
+ *          The number of threads. If less than 1, the number of hardware threads is used.
+ */
+ThreadPool::ThreadPool(int numThreads)
+{
+    running = 0;
+    stopping = false;
+    if(numThreads < 1) numThreads = thread::hardware_concurrency();
+    if(numThreads < 1) numThreads = 1; //hardware_concurrency can return 0 if it is unknown
+    for(int i = 0; i < numThreads; i++)
+    {
+        workers.push_back(thread(&ThreadPool::work, this));
+    }
+}
+
+/**
+ * Destructor that finishes the tasks that were added and then stops the threads.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        unique_lock<mutex> guard(lock);
+        stopping = true;
+    }
+    taskAdded.notify_all();
+    for(unsigned int i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+/**
+ * Adds a task to be run by one of the threads.
+ * @param task
+ *          The task to run.
+ */
+void ThreadPool::add(function<void()> task)
+{
+    {
+        unique_lock<mutex> guard(lock);
+        tasks.push(task);
+    }
+    taskAdded.notify_one();
+}
+
+/**
+ * Waits until all the tasks that were added have finished.
+ */
+void ThreadPool::wait()
+{
+    unique_lock<mutex> guard(lock);
+    while(!tasks.empty() || running > 0)
+    {
+        taskFinished.wait(guard);
+    }
+}
+
+/**
+ * Gets the number of threads in the pool.
+ * @return
+ *          The number of threads.
+ */
+int ThreadPool::size()
+{
+    return workers.size();
+}
+
+/**
+ * Runs tasks until the pool is stopping and there are no tasks left.
+ */
+void ThreadPool::work()
+{
+    while(true)
+    {
+        function<void()> task;
+        {
+            unique_lock<mutex> guard(lock);
+            while(tasks.empty() && !stopping)
+            {
+                taskAdded.wait(guard);
+            }
+            if(tasks.empty()) return; //stopping and nothing left to do
+
+            task = tasks.front();
+            tasks.pop();
+            running++;
+        }
+
+        task();
+
+        {
+            unique_lock<mutex> guard(lock);
+            running--;
+        }
+        taskFinished.notify_all();
+    }
+}
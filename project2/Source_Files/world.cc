@@ -1,20 +1,37 @@
 #include "world.h"
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <math.h>
+#include <unistd.h>
 
 /**
  * Implementation of world.h
  * @author Alex Cole
  */
 
+const int World::SharedTileSize;
+const int World::StateCount;
+
 /**
  * Default constructor that sets initial values to defaults
  */
 World::World()
 {
     automaton = NULL;
+    automatonShared = false;
+    sliceRow = 0;
+    generation = 0;
+    population = 0;
+    stateHash = 0;
+    automatonCurrent = true;
+    stats = NULL;
+    blockDepth = 1;
     rows = 0;
     columns = 0;
+    gridStale = false;
+    sharedTileRows = 0;
+    sharedTileColumns = 0;
 }
 
 /**
@@ -25,35 +42,97 @@ World::World()
 World::World(CellularAutomaton *automaton)
 {
     this->automaton = automaton;
+    this->automatonShared = false;
+    this->sliceRow = 0;
+    this->automatonCurrent = false; //the world cells are what the automaton is printed with, even at generation 0
+    this->stats = NULL;
+    this->blockDepth = 1;
     this->rows = (automaton->getTerrain()->getYEnd() - automaton->getTerrain()->getYStart()) + 1;
     this->columns = (automaton->getTerrain()->getXEnd() - automaton->getTerrain()->getXStart()) + 1;
+    this->sharedTileRows = (rows + SharedTileSize - 1) / SharedTileSize;
+    this->sharedTileColumns = (columns + SharedTileSize - 1) / SharedTileSize;
+    this->gridStale = false;
     terrainCellsToWorldCells();
-    reset();
+
+    generation = 0;
+    population = 0;
+    stateHash = 0;
+    changedCells = initialCells;
+    currentWorld = createWorld(rows + 2, columns + 2);
+    sharedTiles.resize(sharedTileRows * sharedTileColumns);
+    tileStatus.assign(sharedTileRows * sharedTileColumns, TileStatus::CHANGED);
+    updateWorld();
+    initialSnapshot = getSnapshot();
 }
 
 /**
- * Destructor that does not delete the automaton because
- * a copy of the automaton should not be made by world or
- * passed into world.
+ * Destructor that does not delete the automaton passed into world.
+ * A copy made by a fork is deleted once no fork uses it.
  */
 World::~World() {}
 
 /**
- * Copy constructor.
+ * Copy constructor that forks the world, sharing its tiles and its automaton. The fork copies the
+ * automaton before updating it with its cells, so getting the automaton of one fork does not change
+ * the automaton of the world or of any other fork.
  * @param world
  *          The world object that is to be copied.
  */
 World::World(const World &world)
 {
     automaton = world.automaton;
-    currentWorld = world.currentWorld;
+    forkAutomaton = world.forkAutomaton;
+    automatonShared = true;
+    initialSnapshot = world.initialSnapshot;
     changedCells = world.changedCells;
+    sliceCells = world.sliceCells;
+    sliceRow = world.sliceRow;
+    generation = world.generation;
+    population = world.population;
+    stateHash = world.stateHash;
+    automatonCurrent = false; //the shared automaton may be updated by the world after the fork, so the fork makes its own
+    stats = world.stats;
+    blockDepth = world.blockDepth;
     rows = world.rows;
     columns = world.columns;
+    sharedTileRows = world.sharedTileRows;
+    sharedTileColumns = world.sharedTileColumns;
+    gridStale = false;
+    tileStatus.assign(sharedTileRows * sharedTileColumns, TileStatus::STALE);
+    world.shareTiles();
+    useTiles(world.sharedTiles);
 }
 
 /**
- * Overloaded assignment operator.
+ * Constructor that forks the world with a different automaton, so the same cells can be simulated
+ * with a different rule.
+ * @param world
+ *          The world object that is to be copied.
+ * @param automaton
+ *          The automaton for the fork, which must have a terrain of the same size.
+ * @throws InvalidRangeException
+ *          If the terrain of the automaton is not the same size as the world.
+ */
+World::World(const World &world, CellularAutomaton *automaton)
+    : World(world)
+{
+    int automatonRows = (automaton->getTerrain()->getYEnd() - automaton->getTerrain()->getYStart()) + 1;
+    int automatonColumns = (automaton->getTerrain()->getXEnd() - automaton->getTerrain()->getXStart()) + 1;
+    if(automatonRows != rows || automatonColumns != columns) throw InvalidRangeException;
+
+    this->automaton = automaton;
+    forkAutomaton.reset();
+    automatonShared = false;
+    automatonCurrent = false;
+    if(changedCells.size() == 0) //a world that settled under the old rule may change under the new one
+    {
+        changedCells.push_back(Cell(0, 0, getCellState(0, 0))); //listed as changed, but updating the world leaves it as it is
+    }
+}
+
+/**
+ * Overloaded assignment operator that forks the world, sharing its tiles and its automaton until
+ * the fork updates it. Tiles of the grid that already match the tiles of the world are not loaded again.
  * @param world
  *          The world object that is to be copied.
  * @return
@@ -62,11 +141,30 @@ World::World(const World &world)
 World& World::operator=(const World &world)
 {
     if(this == &world) return *this;
+    if(rows != world.rows || columns != world.columns) //none of the grid can be kept
+    {
+        currentWorld.clear();
+        tileStatus.assign(world.sharedTileRows * world.sharedTileColumns, TileStatus::STALE);
+    }
     automaton = world.automaton;
-    currentWorld = world.currentWorld;
+    forkAutomaton = world.forkAutomaton;
+    automatonShared = true;
+    initialSnapshot = world.initialSnapshot;
     changedCells = world.changedCells;
+    sliceCells = world.sliceCells;
+    sliceRow = world.sliceRow;
+    generation = world.generation;
+    population = world.population;
+    stateHash = world.stateHash;
+    automatonCurrent = false; //the shared automaton may be updated by the world after the fork, so the fork makes its own
+    stats = world.stats;
+    blockDepth = world.blockDepth;
     rows = world.rows;
     columns = world.columns;
+    sharedTileRows = world.sharedTileRows;
+    sharedTileColumns = world.sharedTileColumns;
+    world.shareTiles();
+    useTiles(world.sharedTiles);
     return *this;
 }
 
@@ -77,75 +175,182 @@ World& World::operator=(const World &world)
  */
 void World::simulate(int numGenerations)
 {
-    Initial *initial = automaton->getInitial();
+    cancelRows();
+    loadGrid();
+    if(blockDepth > 1 && stats == NULL) //stats are recorded for each generation, so blocks are not used for them
+    {
+        simulateBlocks(numGenerations);
+        numGenerations = 0;
+    }
     for(int i = 0; i < numGenerations; i++)
     {
-        if(changedCells.size() == 0) //if no cells have changed, they will continue to not change, so exit.
-        {
-            initial->convertToTerrainCells(getNonDefaultCells(), automaton->getTerrain());
-            return;
-        }
+        if(changedCells.size() == 0) break; //if no cells have changed, they will continue to not change, so exit.
 
-        changedCells.clear();
-        for(int row = 0; row < rows; row++)
+        Stats::Clock::time_point start;
+        if(stats != NULL)
         {
-            for(int col = 0; col < columns; col++)
-            {
-                State state = automaton->nextCellState(currentWorld, currentWorld[row][col]);
-                if(state != currentWorld[row][col].getState())
-                {
-                    Cell cell(row, col, state);
-                    changedCells.push_back(cell);
-                }
-            }
+            start = Stats::now();
+            stats->startCounters();
         }
-        updateWorld();
+
+        step();
+
+        if(stats != NULL) stats->addGeneration(generation, start, changedCells.size(), population);
     }
+}
 
-    //updates automaton so that current state of automaton can be printed if needed
-    initial->convertToTerrainCells(getNonDefaultCells(), automaton->getTerrain());
+/**
+ * Sets how many generations simulate advances each cache sized tile of the grid at a time. A tile is
+ * copied with a halo of depth cells around it, simulated depth generations and only its interior is
+ * written back, so a large grid is read from memory once every depth generations instead of every
+ * generation. The world ends up exactly as it would one generation at a time. Generations are still
+ * simulated one at a time while stats are being recorded.
+ * @param depth
+ *          The number of generations per tile, 1 or less to simulate one generation at a time.
+ *          Depths too deep for a tile to fit in the cache are reduced.
+ */
+void World::setBlockDepth(int depth)
+{
+    blockDepth = depth;
 }
 
+/**
+ * Simulates one generation without updating the automaton, which is useful when the world is
+ * only looked at through its population and hash.
+ * @return
+ *          True if any cell changed state otherwise false, in which case the world will not change again.
+ */
+bool World::step()
+{
+    cancelRows();
+    if(changedCells.size() == 0) return false;
 
+    loadGrid();
+    changedCells.clear();
+    findChangedCells(0, rows, changedCells);
+    updateWorld();
+    generation++;
+    return changedCells.size() > 0;
+}
 
 /**
- * Gets the world grid based on the terrain specified in the automaton.
+ * Simulates at most the given number of rows of the current generation so a long simulation can
+ * be spread out over several calls. The generation is only applied to the world once all of its
+ * rows have been simulated.
+ * @param maxRows
+ *          The maximum number of rows to simulate before returning.
  * @return
- *          A vector of cell vectors that represents the grid of the world.
+ *          True if the generation has been completed otherwise false.
  */
-vector<vector<Cell>> World::getWorld()
+bool World::simulateRows(int maxRows)
 {
-    return currentWorld;
+    if(sliceRow == 0 && changedCells.size() == 0) return true; //nothing changed last generation, so nothing will change now
+
+    loadGrid();
+    int rowEnd = sliceRow + maxRows < rows ? sliceRow + maxRows : rows;
+    findChangedCells(sliceRow, rowEnd, sliceCells);
+    sliceRow = rowEnd;
+    if(sliceRow < rows) return false;
+
+    //all rows have been checked, so the generation can be applied to the world
+    changedCells.swap(sliceCells);
+    sliceCells.clear();
+    sliceRow = 0;
+    updateWorld();
+    generation++;
+    return true;
 }
 
 /**
- * Creates a world grid based on the window specified in the automaton.
- * @return
- *          A vector of cell vectors that represents the window view of the world.
+ * Discards a partially simulated generation, leaving the world at the last completed generation.
  */
-vector<vector<Cell>> World::generateWindowWorld()
+void World::cancelRows()
 {
-    int winYStart = automaton->getWindow()->getYStart();
-    int winYEnd = automaton->getWindow()->getYEnd();
-    int winXStart = automaton->getWindow()->getXStart();
-    int winXEnd = automaton->getWindow()->getXEnd();
+    sliceCells.clear();
+    sliceRow = 0;
+}
 
-    //creates a window world to make it easy to print later
-    int winRows = (winYEnd - winYStart) + 1;
-    int winCols = (winXEnd - winXStart) + 1;
-    vector<vector<Cell>> windowWorld = createWorld(winRows, winCols);
+/**
+ * Updates the automaton with the cells of the current world so that it can be printed.
+ */
+void World::updateAutomaton()
+{
+    Stats::Clock::time_point start;
+    if(stats != NULL) start = Stats::now();
 
-    //find what position in the world terrain to start filling in window world
-    int terYEnd = automaton->getTerrain()->getYEnd();
-    int terXStart = automaton->getTerrain()->getXStart();
-    int topDiff = winYEnd - terYEnd;
-    int leftDiff = terXStart - winXStart;
+    loadGrid();
+    if(automatonShared) //the world this was forked from may still print the automaton
+    {
+        forkAutomaton.reset(automaton->clone());
+        automaton = forkAutomaton.get();
+        automatonShared = false;
+    }
+    automaton->updateInitial(getNonDefaultCells());
+    automatonCurrent = true;
 
-    int topRow = setStartPos(topDiff, rows);
-    int leftCol = setStartPos(leftDiff, columns);
-    fillWindowWorld(windowWorld, topRow, leftCol);
+    if(stats != NULL) stats->addPhase("terrain cells", start);
+}
+
+/**
+ * Sets the stats that each simulated generation and the conversion of the world back to terrain
+ * cells are recorded to. The stats are not deleted by the world.
+ * @param stats
+ *          The stats to record to or NULL to stop recording.
+ */
+void World::setStats(Stats *stats)
+{
+    this->stats = stats;
+}
 
-    return windowWorld;
+/**
+ * Gets the number of cells that are not in the default state.
+ * @return
+ *          The population of the world.
+ */
+int World::getPopulation()
+{
+    return population;
+}
+
+/**
+ * Gets the number of generations simulated since the world was created or reset, which is less
+ * than were asked for if the simulation stopped once the world stopped changing.
+ * @return
+ *          The generation of the world.
+ */
+int World::getGeneration()
+{
+    return generation;
+}
+
+/**
+ * Gets a hash of the states of all the cells, so repeated states of the world can be found
+ * without comparing grids.
+ * @return
+ *          The hash of the world.
+ */
+unsigned long long World::getHash()
+{
+    return stateHash;
+}
+
+/**
+ * Gets the world grid based on the terrain specified in the automaton.
+ * @return
+ *          A vector of cell vectors that represents the grid of the world.
+ */
+vector<vector<Cell>> World::getWorld()
+{
+    loadGrid();
+    vector<vector<Cell>> ret = createWorld(rows, columns);
+    for(int row = 0; row < rows; row++)
+    {
+        for(int col = 0; col < columns; col++)
+        {
+            ret[row][col].setState(currentWorld[row + 1][col + 1].getState());
+        }
+    }
+    return ret;
 }
 
 /**
@@ -169,12 +374,70 @@ int World::getCols()
 }
 
 /**
- * Gets the current automaton which may have been modified if simulate had been called
+ * Gets the state of a cell.
+ * @param row
+ *          The row of the cell.
+ * @param col
+ *          The column of the cell.
+ * @return
+ *          The state of the cell.
+ */
+State World::getCellState(int row, int col)
+{
+    int tile = sharedTileIndex(row, col);
+    if(tileStatus[tile] != TileStatus::STALE) return currentWorld[row + 1][col + 1].getState();
+
+    int tileRow = row % SharedTileSize;
+    int tileCol = col % SharedTileSize;
+    int tileWidth = min(SharedTileSize, columns - (col - tileCol));
+    return (*sharedTiles[tile])[tileRow * tileWidth + tileCol];
+}
+
+/**
+ * Sets the state of a cell, copying only its tile if the tile is shared with a fork or snapshot.
+ * The cell counts as changed, so the next generation is simulated even if the world had settled.
+ * @param row
+ *          The row of the cell.
+ * @param col
+ *          The column of the cell.
+ * @param state
+ *          The state to set the cell to.
+ */
+void World::setCellState(int row, int col, State state)
+{
+    cancelRows();
+    State oldState = getCellState(row, col);
+    if(oldState == state) return;
+
+    countCellChange(row, col, oldState, state);
+    int tile = sharedTileIndex(row, col);
+    if(tileStatus[tile] == TileStatus::STALE) //the grid has not loaded the tile, so only the tile is changed
+    {
+        if(sharedTiles[tile].use_count() > 1) sharedTiles[tile] = make_shared<vector<State>>(*sharedTiles[tile]);
+        int tileRow = row % SharedTileSize;
+        int tileCol = col % SharedTileSize;
+        int tileWidth = min(SharedTileSize, columns - (col - tileCol));
+        (*sharedTiles[tile])[tileRow * tileWidth + tileCol] = state;
+    }
+    else
+    {
+        currentWorld[row + 1][col + 1].setState(state);
+        tileStatus[tile] = TileStatus::CHANGED;
+        if(row == 0 || row == rows - 1 || col == 0 || col == columns - 1) updateGhostCells();
+    }
+    changedCells.push_back(Cell(row, col, state));
+    automatonCurrent = false;
+}
+
+/**
+ * Gets the automaton, first updating its initial cells to the cells of the current world if any
+ * have changed since they were last updated. A fork updates its own copy of the automaton.
  * @return
  *          A pointer to world's automaton
  */
 CellularAutomaton* World::getAutomaton()
 {
+    if(!automatonCurrent) updateAutomaton();
     return automaton;
 }
 
@@ -189,11 +452,11 @@ string World::toString()
 {
     if(automaton->getWindow() == NULL) //if NULL, then print terrain world
     {
-        return toStringWorld(currentWorld);
+        return toString(automaton->getTerrain());
     }
     else //otherwise print window world
     {
-        return toStringWindow();
+        return toString(automaton->getWindow());
     }
 }
 
@@ -208,12 +471,94 @@ vector<vector<Color>> World::toColor()
 {
     if(automaton->getWindow() == NULL) //behaves similar to toString()
     {
-        return toColorWorld(currentWorld);
+        return toColor(automaton->getTerrain());
     }
     else
     {
-        return toColorWindow();
+        return toColor(automaton->getWindow());
+    }
+}
+
+/**
+ * String representation of a view of the world through a window, which can be any window and
+ * not only the window of the automaton, so several views of the world can be shown at once. Each
+ * row is written straight from the grid in wrapped segments, and columns and rows that repeat
+ * because the window is bigger than the terrain are copied from the part already written.
+ * @param window
+ *          The window to view the world through, in terrain coordinates.
+ * @return
+ *          String representation of the window view of the world.
+ */
+string World::toString(Range *window)
+{
+    loadGrid();
+    int topRow, leftCol, winRows, winCols;
+    windowPosition(window, topRow, leftCol, winRows, winCols);
+
+    char stateChars[StateCount] = {};
+    for(int state = (int) State::DEFAULT; state < StateCount; state++)
+    {
+        Cell cell(0, 0, (State) state);
+        stateChars[state] = automaton->getChar(cell);
+    }
+
+    string ret(winRows * (winCols + 1), '\n');
+    vector<int> windowRows(rows, -1); //the window row each grid row was first written to
+    for(int winRow = 0; winRow < winRows; winRow++)
+    {
+        char *out = &ret[winRow * (winCols + 1)];
+        int row = windowRow(winRow, topRow);
+        if(windowRows[row] >= 0)
+        {
+            copy(&ret[windowRows[row] * (winCols + 1)], &ret[windowRows[row] * (winCols + 1)] + winCols, out);
+        }
+        else
+        {
+            renderRow(out, stateChars, row, leftCol, winCols);
+            windowRows[row] = winRow;
+        }
+    }
+    return ret;
+}
+
+/**
+ * Color grid of a view of the world through a window, which can be any window and not only the
+ * window of the automaton, so several views of the world can be shown at once.
+ * @param window
+ *          The window to view the world through, in terrain coordinates.
+ * @return
+ *          A color grid of the window view of the world.
+ */
+vector<vector<Color>> World::toColor(Range *window)
+{
+    loadGrid();
+    int topRow, leftCol, winRows, winCols;
+    windowPosition(window, topRow, leftCol, winRows, winCols);
+
+    Color stateColors[StateCount];
+    for(int state = (int) State::DEFAULT; state < StateCount; state++)
+    {
+        Cell cell(0, 0, (State) state);
+        stateColors[state] = automaton->getColor(cell);
     }
+
+    vector<vector<Color>> ret(winRows);
+    vector<int> windowRows(rows, -1);
+    for(int winRow = 0; winRow < winRows; winRow++)
+    {
+        int row = windowRow(winRow, topRow);
+        if(windowRows[row] >= 0)
+        {
+            ret[winRow] = ret[windowRows[row]];
+        }
+        else
+        {
+            ret[winRow].resize(winCols);
+            renderRow(&ret[winRow][0], stateColors, row, leftCol, winCols);
+            windowRows[row] = winRow;
+        }
+    }
+    return ret;
 }
 
 /**
@@ -221,9 +566,40 @@ vector<vector<Color>> World::toColor()
  */
 void World::reset()
 {
-    changedCells = initialCells;
-    currentWorld = createWorld(rows, columns);
-    updateWorld();
+    reset(initialSnapshot);
+}
+
+/**
+ * Resets the world to a snapshot, so different changes can be tried from the same state.
+ * @param snapshot
+ *          A snapshot taken from this world.
+ */
+void World::reset(const WorldSnapshot &snapshot)
+{
+    cancelRows();
+    useTiles(snapshot.tiles); //the tiles are loaded when the grid is next needed
+    changedCells = snapshot.changedCells;
+    generation = snapshot.generation;
+    population = snapshot.population;
+    stateHash = snapshot.stateHash;
+    automatonCurrent = false;
+}
+
+/**
+ * Takes a snapshot of the current state of the world.
+ * @return
+ *          The snapshot, which the world can be reset to.
+ */
+WorldSnapshot World::getSnapshot()
+{
+    WorldSnapshot snapshot;
+    shareTiles();
+    snapshot.tiles = sharedTiles;
+    snapshot.changedCells = changedCells;
+    snapshot.generation = generation;
+    snapshot.population = population;
+    snapshot.stateHash = stateHash;
+    return snapshot;
 }
 
 /**
@@ -261,95 +637,430 @@ void World::updateWorld()
     {
         int row = changedCells[i].getX();
         int col = changedCells[i].getY();
-        currentWorld[row][col].setState(changedCells[i].getState());
+        State state = changedCells[i].getState();
+        State oldState = currentWorld[row + 1][col + 1].getState();
+        if(oldState == state) continue;
+
+        countCellChange(row, col, oldState, state);
+        currentWorld[row + 1][col + 1].setState(state);
+        tileStatus[sharedTileIndex(row, col)] = TileStatus::CHANGED;
+        automatonCurrent = false;
     }
+    updateGhostCells();
 }
 
 /**
- * Creates a string version of the window view of the world.
- * @return
- *          The string representation of the window view of the world.
+ * Copies the cells on each edge of the grid to the ghost cells past the opposite edge, so the
+ * neighbors of every cell are in the grid and wrap around the terrain.
  */
-string World::toStringWindow()
+void World::updateGhostCells()
 {
-    return toStringWorld(generateWindowWorld());
+    for(int row = 1; row <= rows; row++)
+    {
+        currentWorld[row][0].setState(currentWorld[row][columns].getState());
+        currentWorld[row][columns + 1].setState(currentWorld[row][1].getState());
+    }
+    for(int col = 0; col <= columns + 1; col++) //includes the corners, which were just set in the edge rows
+    {
+        currentWorld[0][col].setState(currentWorld[rows][col].getState());
+        currentWorld[rows + 1][col].setState(currentWorld[1][col].getState());
+    }
 }
 
 /**
- * Creates a color grid based on the window view of the world.
+ * Adds the change of a cell state to the population and hash of the world.
+ * @param row
+ *          The row of the cell.
+ * @param col
+ *          The column of the cell.
+ * @param oldState
+ *          The state the cell was in.
+ * @param state
+ *          The state the cell is in now.
+ */
+void World::countCellChange(int row, int col, State oldState, State state)
+{
+    if(oldState == State::DEFAULT) population++;
+    else stateHash -= cellHash(row, col, oldState);
+    if(state == State::DEFAULT) population--;
+    else stateHash += cellHash(row, col, state);
+}
+
+/**
+ * Gets the index of the shared tile a cell is in.
+ * @param row
+ *          The row of the cell.
+ * @param col
+ *          The column of the cell.
  * @return
- *          A vector of color vectors that represent the window view of the world.
+ *          The index of the tile.
  */
-vector<vector<Color>> World::toColorWindow()
+int World::sharedTileIndex(int row, int col)
 {
-    return toColorWorld(generateWindowWorld());
+    return (row / SharedTileSize) * sharedTileColumns + col / SharedTileSize;
 }
 
 /**
- * Creates a world with the given rows and columns and sets all states to default.
- * @param rows
- *          The number of rows.
- * @param columns
- *          The number of columns.
+ * Makes the shared tiles of the grid tiles that have changed again, so the shared tiles hold the
+ * current world. A tile that is not shared is reused.
+ */
+void World::shareTiles() const
+{
+    for(int tileRow = 0; tileRow < sharedTileRows; tileRow++)
+    {
+        for(int tileCol = 0; tileCol < sharedTileColumns; tileCol++)
+        {
+            int tile = tileRow * sharedTileColumns + tileCol;
+            if(tileStatus[tile] != TileStatus::CHANGED) continue;
+
+            int rowStart = tileRow * SharedTileSize;
+            int colStart = tileCol * SharedTileSize;
+            int height = min(SharedTileSize, rows - rowStart);
+            int width = min(SharedTileSize, columns - colStart);
+            if(sharedTiles[tile] == NULL || sharedTiles[tile].use_count() > 1) //snapshots and forks keep the old tile
+            {
+                sharedTiles[tile] = make_shared<vector<State>>(height * width);
+            }
+            vector<State> &states = *sharedTiles[tile];
+            for(int row = 0; row < height; row++)
+            {
+                const vector<Cell> &current = currentWorld[rowStart + row + 1];
+                for(int col = 0; col < width; col++)
+                {
+                    states[row * width + col] = current[colStart + col + 1].getState();
+                }
+            }
+            tileStatus[tile] = TileStatus::SHARED;
+        }
+    }
+}
+
+/**
+ * Switches the world to the given tiles, marking every tile of the grid stale unless it already
+ * holds the same states as the tile.
+ * @param tiles
+ *          The tiles of a world of the same size.
+ */
+void World::useTiles(const vector<shared_ptr<vector<State>>> &tiles)
+{
+    for(unsigned int tile = 0; tile < tiles.size(); tile++)
+    {
+        if(currentWorld.empty() || tileStatus[tile] != TileStatus::SHARED || sharedTiles[tile] != tiles[tile])
+        {
+            tileStatus[tile] = TileStatus::STALE;
+            gridStale = true;
+        }
+    }
+    sharedTiles = tiles;
+}
+
+/**
+ * Loads the stale tiles of the grid from their shared tiles, creating the grid if the world does
+ * not have one yet.
+ */
+void World::loadGrid()
+{
+    if(!gridStale) return;
+    if(currentWorld.empty()) currentWorld = createWorld(rows + 2, columns + 2);
+
+    for(int tileRow = 0; tileRow < sharedTileRows; tileRow++)
+    {
+        for(int tileCol = 0; tileCol < sharedTileColumns; tileCol++)
+        {
+            int tile = tileRow * sharedTileColumns + tileCol;
+            if(tileStatus[tile] != TileStatus::STALE) continue;
+
+            int rowStart = tileRow * SharedTileSize;
+            int colStart = tileCol * SharedTileSize;
+            int height = min(SharedTileSize, rows - rowStart);
+            int width = min(SharedTileSize, columns - colStart);
+            const vector<State> &states = *sharedTiles[tile];
+            for(int row = 0; row < height; row++)
+            {
+                vector<Cell> &current = currentWorld[rowStart + row + 1];
+                for(int col = 0; col < width; col++)
+                {
+                    current[colStart + col + 1].setState(states[row * width + col]);
+                }
+            }
+            tileStatus[tile] = TileStatus::SHARED;
+        }
+    }
+    updateGhostCells();
+    gridStale = false;
+}
+
+/**
+ * Gets the hash of one cell in the given state, which is added to the world hash while the cell
+ * is in that state.
+ * @param row
+ *          The row of the cell.
+ * @param col
+ *          The column of the cell.
+ * @param state
+ *          The state of the cell.
  * @return
- *          The world as a vector of cell vectors with all cells set to default
+ *          The hash of the cell.
  */
-vector<vector<Cell>> World::createWorld(int rows, int columns)
+unsigned long long World::cellHash(int row, int col, State state)
 {
-    vector<vector<Cell>> ret;
-    for(int row = 0; row < rows; row++)
+    //mixes the position and state so that sums of cell hashes rarely collide
+    unsigned long long hash = ((unsigned long long) row * columns + col) * 8 + (int) state + 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+}
+
+/**
+ * Simulates the given number of generations a block of generations at a time by simulating each
+ * tile of the grid for the whole block, stopping early if a generation changes no cells.
+ * @param numGenerations
+ *          The number of generations to simulate.
+ */
+void World::simulateBlocks(int numGenerations)
+{
+    int depth = blockDepth;
+    int tileSize = blockTileSize(depth);
+    vector<vector<Cell>> tiles[] = { createWorld(tileSize + 2 * depth, tileSize + 2 * depth), createWorld(tileSize + 2 * depth, tileSize + 2 * depth) };
+
+    while(numGenerations > 0 && changedCells.size() > 0)
     {
-        ret.push_back(vector<Cell>(columns));
-        for(int col = 0; col < columns; col++)
+        int blockGenerations = depth < numGenerations ? depth : numGenerations;
+        vector<Cell> blockCells;
+        vector<Cell> lastCells;
+        int lastChange = 0;
+        for(int row = 0; row < rows; row += tileSize)
         {
-            ret[row][col].setX(row);
-            ret[row][col].setY(col);
+            for(int col = 0; col < columns; col += tileSize)
+            {
+                int tileRows = row + tileSize < rows ? tileSize : rows - row;
+                int tileCols = col + tileSize < columns ? tileSize : columns - col;
+                int tileChange = simulateTile(row, col, tileRows, tileCols, blockGenerations, tiles, blockCells, lastCells);
+                if(tileChange > lastChange) lastChange = tileChange;
+            }
         }
+
+        changedCells.swap(blockCells);
+        updateWorld();
+        changedCells.swap(lastCells); //the cells that changed in the last generation, as if it were simulated on its own
+
+        //once a generation changes no cells none after it will, and one generation at a time would stop after that generation
+        generation += lastChange < blockGenerations ? lastChange + 1 : blockGenerations;
+        numGenerations -= blockGenerations;
     }
-    return ret;
 }
 
 /**
- * Converts a given world to a string representation of the world.
- * @param world
- *          The world to convert into a string.
+ * Copies a tile of the grid and a halo around it and simulates it for a block of generations. Cells
+ * within n cells of the edge of the halo depend on cells outside of it after n generations, so each
+ * generation is simulated on a smaller area until only the tile is left.
+ * @param rowStart
+ *          The first row of the tile.
+ * @param colStart
+ *          The first column of the tile.
+ * @param tileRows
+ *          The number of rows in the tile.
+ * @param tileCols
+ *          The number of columns in the tile.
+ * @param depth
+ *          The number of generations to simulate, which is also the width of the halo.
+ * @param tiles
+ *          Two grids big enough for the tile and its halo that generations are simulated between.
+ * @param blockCells
+ *          The cell vector the tile cells that differ from the grid after the block are added to.
+ * @param lastCells
+ *          The cell vector the tile cells that changed in the last generation of the block are added to.
  * @return
- *          A string representation of given world.
+ *          The last generation of the block that changed a cell of the tile, 0 if none did.
  */
-string World::toStringWorld(vector<vector<Cell>> world)
+int World::simulateTile(int rowStart, int colStart, int tileRows, int tileCols, int depth, vector<vector<Cell>> tiles[],
+    vector<Cell> &blockCells, vector<Cell> &lastCells)
 {
-    string ret = "";
-    for(unsigned int row = 0; row < world.size(); row++)
+    int haloRows = tileRows + 2 * depth;
+    int haloCols = tileCols + 2 * depth;
+    vector<vector<Cell>> *current = &tiles[0];
+    vector<vector<Cell>> *next = &tiles[1];
+
+    //the halo wraps around the grid the same way neighbors do
+    int row = ((rowStart - depth) % rows + rows) % rows;
+    for(int tileRow = 0; tileRow < haloRows; tileRow++)
     {
-        for(unsigned int col = 0; col < world[0].size(); col++)
+        int col = ((colStart - depth) % columns + columns) % columns;
+        for(int tileCol = 0; tileCol < haloCols; tileCol++)
         {
-            char ch = automaton->getChar(world[row][col]);
-            ret += ch;
+            (*current)[tileRow][tileCol].setState(currentWorld[row + 1][col + 1].getState());
+            col = col + 1 < columns ? col + 1 : 0;
         }
-        ret += "\n";
+        row = row + 1 < rows ? row + 1 : 0;
     }
-    return ret;
+
+    int lastChange = 0;
+    for(int gen = 1; gen <= depth; gen++)
+    {
+        automaton->nextStates(*current, *next, gen, haloRows - gen, gen, haloCols - gen);
+        for(int tileRow = depth; tileRow < depth + tileRows; tileRow++)
+        {
+            for(int tileCol = depth; tileCol < depth + tileCols; tileCol++)
+            {
+                State state = (*next)[tileRow][tileCol].getState();
+                if(state != (*current)[tileRow][tileCol].getState())
+                {
+                    lastChange = gen;
+                    if(gen == depth) lastCells.push_back(Cell(rowStart + tileRow - depth, colStart + tileCol - depth, state));
+                }
+            }
+        }
+        swap(current, next);
+    }
+
+    for(int tileRow = depth; tileRow < depth + tileRows; tileRow++)
+    {
+        for(int tileCol = depth; tileCol < depth + tileCols; tileCol++)
+        {
+            State state = (*current)[tileRow][tileCol].getState();
+            if(state != currentWorld[rowStart + tileRow - depth + 1][colStart + tileCol - depth + 1].getState())
+            {
+                blockCells.push_back(Cell(rowStart + tileRow - depth, colStart + tileCol - depth, state));
+            }
+        }
+    }
+    return lastChange;
 }
 
 /**
- * Converts a given world to a color representation of the world.
- * @param world
- *          The world to convert into a color world.
+ * Finds the size of a tile such that two grids of a tile and its halo fit in the L2 cache, reducing
+ * the depth if it is too deep for a useful tile to fit.
+ * @param depth
+ *          The number of generations per tile, which is reduced if it is too deep.
  * @return
- *          A vector of color vectors that represents a color version of the world.
+ *          The number of rows and columns in a tile.
+ */
+int World::blockTileSize(int &depth)
+{
+    long cacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if(cacheSize <= 0) cacheSize = 256 * 1024; //not reported on every system
+
+    int side = (int) sqrt((double) cacheSize / (2 * sizeof(Cell)));
+    if(depth > side / 4) depth = side / 4 > 1 ? side / 4 : 1; //the tile should be at least half of the side
+    return side - 2 * depth;
+}
+
+/**
+ * Finds the cells in the given rows that will change state in the next generation.
+ * @param rowStart
+ *          The first row to check.
+ * @param rowEnd
+ *          The row after the last row to check.
+ * @param cells
+ *          The cell vector the changed cells are added to.
+ */
+void World::findChangedCells(int rowStart, int rowEnd, vector<Cell> &cells)
+{
+    automaton->findChangedCells(currentWorld, rowStart, rowEnd, cells);
+}
+
+/**
+ * Finds the size of a window and the row and column of the grid its top left corner is at.
+ * @param window
+ *          The window in terrain coordinates.
+ * @param topRow
+ *          Set to the row of the grid the window starts at.
+ * @param leftCol
+ *          Set to the column of the grid the window starts at.
+ * @param winRows
+ *          Set to the number of rows in the window.
+ * @param winCols
+ *          Set to the number of columns in the window.
  */
-vector<vector<Color>> World::toColorWorld(vector<vector<Cell>> world)
+void World::windowPosition(Range *window, int &topRow, int &leftCol, int &winRows, int &winCols)
 {
-    vector<vector<Color>> ret;
-    for(unsigned int row = 0; row < world.size(); row++)
+    winRows = (window->getYEnd() - window->getYStart()) + 1;
+    winCols = (window->getXEnd() - window->getXStart()) + 1;
+
+    //find what position in the world terrain the window starts at
+    int topDiff = window->getYEnd() - automaton->getTerrain()->getYEnd();
+    int leftDiff = automaton->getTerrain()->getXStart() - window->getXStart();
+    topRow = setStartPos(topDiff, rows);
+    leftCol = setStartPos(leftDiff, columns);
+}
+
+/**
+ * Gets the row of the grid shown in a row of a window. The rows from the top row down are shown in
+ * order, wrapping around to the first row of the terrain, except that a window starting at the last
+ * row shows it twice before wrapping.
+ * @param winRow
+ *          The row of the window.
+ * @param topRow
+ *          The row of the grid the window starts at.
+ * @return
+ *          The row of the grid.
+ */
+int World::windowRow(int winRow, int topRow)
+{
+    if(topRow == rows - 1 && winRow > 0) //the first row is shown twice when the window starts at the last row
+    {
+        return (topRow + winRow - 1) % rows;
+    }
+    return (topRow + winRow) % rows;
+}
+
+/**
+ * Writes a row of a window from a row of the grid, looking up the value of each state in a table.
+ * The row is read in at most two segments that wrap around the terrain, and the rest of a window
+ * wider than the terrain is copied from the columns already written.
+ * @param out
+ *          Where the row of the window is written.
+ * @param table
+ *          The value written for each state.
+ * @param row
+ *          The row of the grid.
+ * @param leftCol
+ *          The column of the grid the window starts at.
+ * @param winCols
+ *          The number of columns in the window.
+ */
+template<class T>
+void World::renderRow(T *out, const T table[], int row, int leftCol, int winCols)
+{
+    const vector<Cell> &current = currentWorld[row + 1];
+    int first = min(winCols, columns - leftCol); //from the left column to the edge of the terrain
+    for(int col = 0; col < first; col++)
+    {
+        out[col] = table[(int) current[leftCol + col + 1].getState()];
+    }
+    int second = min(winCols - first, leftCol); //wraps around to the columns left of the window
+    for(int col = 0; col < second; col++)
     {
-        ret.push_back(vector<Color>(world[row].size()));
-        for(unsigned int col = 0; col < world[row].size(); col++)
+        out[first + col] = table[(int) current[col + 1].getState()];
+    }
+
+    //every column of the terrain has been written once, so the rest repeats what has been written
+    for(int done = first + second; done < winCols; done += columns)
+    {
+        int length = min(columns, winCols - done);
+        copy(out + done - columns, out + done - columns + length, out + done);
+    }
+}
+
+/**
+ * Creates a world with the given rows and columns and sets all states to default.
+ * @param rows
+ *          The number of rows.
+ * @param columns
+ *          The number of columns.
+ * @return
+ *          The world as a vector of cell vectors with all cells set to default
+ */
+vector<vector<Cell>> World::createWorld(int rows, int columns)
+{
+    vector<vector<Cell>> ret;
+    for(int row = 0; row < rows; row++)
+    {
+        ret.push_back(vector<Cell>(columns));
+        for(int col = 0; col < columns; col++)
         {
-            Color color = automaton->getColor(world[row][col]);
-            ret[row][col].setRed(color.getRed());
-            ret[row][col].setGreen(color.getGreen());
-            ret[row][col].setBlue(color.getBlue());
+            ret[row][col].setX(row);
+            ret[row][col].setY(col);
         }
     }
     return ret;
@@ -383,46 +1094,6 @@ int World::setStartPos(int diff, int length)
     return ret;
 }
 
-/**
- * Fills the window world with values from the terrain based on terrain starting positions.
- * @param windowWorld
- *          The window view of the world.
- * @param rowStart
- *          The row to start at in the terrain.
- * @param colStart
- *          The column to start at in the terrain.
- */
-void World::fillWindowWorld(vector<vector<Cell>> &windowWorld, int rowStart, int colStart)
-{
-    int row = rowStart;
-    for(unsigned int winRow = 0; winRow < windowWorld.size(); winRow++) //go through window world
-    {
-        int col = colStart; //need to reset back to colstart value
-        for(unsigned int winCol = 0; winCol < windowWorld[0].size(); winCol++)
-        {
-            State state = currentWorld[row][col].getState();
-            if(state != State::DEFAULT)
-            {
-                windowWorld[winRow][winCol].setState(state);
-            }
-            col++;
-            if(col > columns - 1) //if this is true, terrain world column needs to be set back to 0
-            {
-                col = 0;
-            }
-        }
-        row++;
-        if(row > rows - 1 && winRow == 0) //if still on the first window row, the row value needs to be reset to rowstart
-        {
-            row = rowStart;
-        }
-        else if(row > rows -1) //otherwise if exceeding terrain world, row reset to 0
-        {
-            row = 0;
-        }
-    }
-}
-
 /**
  * Gets the cells in the world that are not in the default state.
  * @return
@@ -435,12 +1106,10 @@ vector<Cell> World::getNonDefaultCells()
     {
         for(unsigned int col = 0; col < columns; col++)
         {
-            State state = currentWorld[row][col].getState();
+            State state = currentWorld[row + 1][col + 1].getState();
             if(state != State::DEFAULT)
             {
-                int x = currentWorld[row][col].getX();
-                int y = currentWorld[row][col].getY();
-                Cell cell(x, y, state);
+                Cell cell(row, col, state);
                 ret.push_back(cell);
             }
         }
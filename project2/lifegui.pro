@@ -19,6 +19,7 @@ HEADERS += cell.h \
 	   lifeinitial.h \
 	   cellularautomaton.h \
 	   ruleautomaton.h \
+	   automatonsteps.h \
 	   lifewidget.h \
 	   control.h \
            automatonparser.h \
@@ -26,6 +27,8 @@ HEADERS += cell.h \
            range.h \
            settings.h \
            world.h \
+           stats.h \
+           perfcounters.h \
 	   brian.h \
 	   brianchars.h \
 	   briancolors.h \
@@ -54,6 +57,8 @@ SOURCES += cell.cc \
            range.cc \
            settings.cc \
            world.cc \
+           stats.cc \
+           perfcounters.cc \
 	   brian.cc \
 	   brianchars.cc \
 	   briancolors.cc \